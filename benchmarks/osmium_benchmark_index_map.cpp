@@ -8,6 +8,8 @@
 #include <osmium/handler/node_locations_for_ways.hpp>
 #include <osmium/index/map/all.hpp>
 #include <osmium/io/any_input.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
 #include <osmium/visitor.hpp>
 
 #include <cstdlib>
@@ -19,14 +21,15 @@ using index_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmi
 using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " OSMFILE FORMAT\n";
+    if (argc < 3 || argc > 4 || (argc == 4 && std::string{argv[3]} != "prefetch")) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE FORMAT [prefetch]\n";
         return 1;
     }
 
     try {
         const std::string input_filename{argv[1]};
         const std::string location_store{argv[2]};
+        const bool use_prefetch = argc == 4;
 
         osmium::io::Reader reader{input_filename};
 
@@ -35,7 +38,19 @@ int main(int argc, char* argv[]) {
         location_handler_type location_handler{*index};
         location_handler.ignore_errors();
 
-        osmium::apply(reader, location_handler);
+        if (use_prefetch) {
+            // Handle all ways in a buffer at once, so the location handler
+            // can prefetch index entries for node refs of later ways.
+            while (osmium::memory::Buffer buffer = reader.read()) {
+                for (const auto& node : buffer.select<osmium::Node>()) {
+                    location_handler.node(node);
+                }
+                auto ways = buffer.select<osmium::Way>();
+                location_handler.ways(ways.begin(), ways.end());
+            }
+        } else {
+            osmium::apply(reader, location_handler);
+        }
         reader.close();
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
@@ -44,4 +59,3 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
-
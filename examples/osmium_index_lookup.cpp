@@ -6,6 +6,8 @@
 
   You can use the osmium_dump_internal example program to create the offset
   indexes or osmium_location_cache_create to create a node location index.
+  Location cache files are detected automatically, the --array and --list
+  options are ignored for them.
 
   DEMONSTRATES USE OF:
   * access to indexes on disk
@@ -41,6 +43,9 @@
 #include <osmium/index/map/dense_file_array.hpp>
 #include <osmium/index/map/sparse_file_array.hpp>
 
+// Location cache files
+#include <osmium/index/map/location_cache.hpp>
+
 // osmium::Location
 #include <osmium/osm/location.hpp>
 
@@ -186,6 +191,40 @@ public:
 
 }; // class IndexAccessSparse
 
+// Implementation of IndexAccess for location cache files written by
+// osmium_location_cache_create.
+class IndexAccessLocationCache : public IndexAccess<osmium::Location> {
+
+    using index_type = osmium::index::map::LocationCache<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type m_index;
+
+public:
+
+    explicit IndexAccessLocationCache(int fd) :
+        IndexAccess<osmium::Location>(fd),
+        m_index(fd) {
+    }
+
+    void dump() const override {
+        m_index.for_each([](osmium::unsigned_object_id_type id, const osmium::Location& location) {
+            std::cout << id << " " << location << "\n";
+        });
+    }
+
+    bool search(const osmium::unsigned_object_id_type& key) const override {
+        const osmium::Location location = m_index.get_noexcept(key);
+        if (!location) {
+            std::cout << key << " not found\n";
+            return false;
+        }
+
+        std::cout << key << " " << location << "\n";
+        return true;
+    }
+
+}; // class IndexAccessLocationCache
+
 // This class contains the code to parse the command line arguments, check
 // them and present the results to the rest of the program in an easy-to-use
 // way.
@@ -335,6 +374,15 @@ std::unique_ptr<IndexAccess<TValue>> create(bool dense, int fd) {
     return ptr;
 }
 
+// Use location cache if the file is one, otherwise use a plain index.
+std::unique_ptr<IndexAccess<osmium::Location>> create_location_index(bool dense, int fd) {
+    try {
+        return std::unique_ptr<IndexAccess<osmium::Location>>{new IndexAccessLocationCache{fd}};
+    } catch (const osmium::location_cache_error&) {
+        return create<osmium::Location>(dense, fd);
+    }
+}
+
 // Do the actual work: Either dump the index or search in the index.
 template <typename TValue>
 int run(const IndexAccess<TValue>& index, const Options& options) {
@@ -365,7 +413,7 @@ int main(int argc, char* argv[]) {
         // Depending on the type of index, we have different implementations.
         if (options.type_is("location")) {
             // index id -> location
-            const auto index = create<osmium::Location>(options.dense_format(), fd);
+            const auto index = create_location_index(options.dense_format(), fd);
             return run(*index, options);
         }
 
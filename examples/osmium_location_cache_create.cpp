@@ -5,14 +5,21 @@
   Reads nodes from an OSM file and writes out their locations to a cache
   file. The cache file can then be read with osmium_location_cache_use.
 
+  The cache file has a header describing the data (dense or sparse, Id
+  range, timestamp of the input file, checksum) so it can be checked before
+  it is used.
+
+  The node locations are written directly into the cache file while
+  reading the input, so the input file must be sorted by node ID (as OSM
+  files usually are).
+
   Warning: The locations cache file will get huge (>32GB) if you are using
-           the DenseFileArray index even if the input file is small, because
-           it depends on the *largest* node ID, not the number of nodes.
+           the dense type even if the input file is small, because it
+           depends on the *largest* node ID, not the number of nodes.
 
   DEMONSTRATES USE OF:
   * file input
-  * location indexes and the NodeLocationsForWays handler
-  * location indexes on disk
+  * writing location cache files
 
   SIMPLER EXAMPLES you might want to understand first:
   * osmium_read
@@ -34,29 +41,48 @@
 
 #ifdef _WIN32
 # include <io.h>       // for _setmode
+#else
+# include <unistd.h>   // for close
 #endif
 
 // Allow any format of input files (XML, PBF, ...)
 #include <osmium/io/any_input.hpp>
 
-// For the location index. There are different types of index implementation
-// available. These implementations put the index on disk. See below.
-#include <osmium/index/map/dense_file_array.hpp>
-#include <osmium/index/map/sparse_file_array.hpp>
+// For writing the location cache file.
+#include <osmium/index/map/location_cache.hpp>
 
-// For the NodeLocationForWays handler
-#include <osmium/handler/node_locations_for_ways.hpp>
+// For the handler base class
+#include <osmium/handler.hpp>
 
 // For osmium::apply()
 #include <osmium/visitor.hpp>
 
 // Chose one of these two. "sparse" is best used for small and medium extracts,
-// the "dense" index for large extracts or the whole planet.
-using index_type = osmium::index::map::SparseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
-//using index_type = osmium::index::map::DenseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
+// the "dense" type for large extracts or the whole planet.
+constexpr const auto cache_type = osmium::index::map::location_cache_type::sparse;
+//constexpr const auto cache_type = osmium::index::map::location_cache_type::dense;
+
+using cache_writer_type = osmium::index::map::LocationCacheWriter<osmium::unsigned_object_id_type, osmium::Location>;
+
+// Handler writing the locations of all nodes into the cache file.
+class CacheWriterHandler : public osmium::handler::Handler {
 
-// The location handler always depends on the index type
-using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+    cache_writer_type& m_writer;
+
+public:
+
+    explicit CacheWriterHandler(cache_writer_type& writer) :
+        m_writer(writer) {
+    }
+
+    void node(const osmium::Node& node) {
+        // Negative IDs (from editors) are not stored in the cache.
+        if (node.id() >= 0) {
+            m_writer.set(node.positive_id(), node.location());
+        }
+    }
+
+}; // class CacheWriterHandler
 
 int main(int argc, char* argv[]) {
     if (argc != 3) {
@@ -71,7 +97,11 @@ int main(int argc, char* argv[]) {
         // Construct Reader reading only nodes
         osmium::io::Reader reader{input_filename, osmium::osm_entity_bits::node};
 
-        // Initialize location index on disk creating a new file.
+        // The timestamp of the input data will be stored in the cache file.
+        const std::string timestamp_str{reader.header().get("osmosis_replication_timestamp")};
+        const osmium::Timestamp timestamp{timestamp_str.empty() ? osmium::Timestamp{} : osmium::Timestamp{timestamp_str}};
+
+        // Open the location cache file creating a new file.
         const int fd = ::open(cache_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666); // NOLINT(hicpp-signed-bitwise)
         if (fd == -1) {
             std::cerr << "Can not open location cache file '" << cache_filename << "': " << std::strerror(errno) << "\n";
@@ -80,16 +110,22 @@ int main(int argc, char* argv[]) {
 #ifdef _WIN32
         _setmode(fd, _O_BINARY);
 #endif
-        index_type index{fd};
 
-        // The handler that stores all node locations in the index.
-        location_handler_type location_handler{index};
+        // The writer writes the header and then the locations directly
+        // into the cache file.
+        cache_writer_type writer{fd, cache_type, timestamp};
 
-        // Feed all nodes through the location handler.
-        osmium::apply(reader, location_handler);
+        // Feed all nodes through the handler writing them to the cache.
+        CacheWriterHandler handler{writer};
+        osmium::apply(reader, handler);
 
         // Explicitly close input so we get notified of any errors.
         reader.close();
+
+        // Fill in the header of the location cache file.
+        const auto header = writer.close();
+        std::cout << "Wrote " << header.count << " entries for Ids up to " << header.max_id << "\n";
+        ::close(fd);
     } catch (const std::exception& e) {
         // All exceptions used by the Osmium library derive from std::exception.
         std::cerr << e.what() << '\n';
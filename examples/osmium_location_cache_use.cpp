@@ -5,9 +5,9 @@
   This reads ways from an OSM file and writes out the way node locations
   it got from a location cache generated with osmium_location_cache_create.
 
-  Warning: The locations cache file will get huge (>32GB) if you are using
-           the DenseFileArray index even if the input file is small, because
-           it depends on the *largest* node ID, not the number of nodes.
+  The location cache file is memory mapped, so it can be used immediately.
+  Its header tells us whether it is a dense or sparse cache and which
+  timestamp the data it was created from had.
 
   DEMONSTRATES USE OF:
   * file input
@@ -34,15 +34,15 @@
 
 #ifdef _WIN32
 # include <io.h>       // for _setmode
+#else
+# include <unistd.h>   // for close
 #endif
 
 // Allow any format of input files (XML, PBF, ...)
 #include <osmium/io/any_input.hpp>
 
-// For the location index. There are different types of index implementation
-// available. These implementations put the index on disk. See below.
-#include <osmium/index/map/dense_file_array.hpp>
-#include <osmium/index/map/sparse_file_array.hpp>
+// For the location cache file.
+#include <osmium/index/map/location_cache.hpp>
 
 // For the NodeLocationForWays handler
 #include <osmium/handler/node_locations_for_ways.hpp>
@@ -50,10 +50,8 @@
 // For osmium::apply()
 #include <osmium/visitor.hpp>
 
-// Chose one of these two. "sparse" is best used for small and medium extracts,
-// the "dense" index for large extracts or the whole planet.
-using index_type = osmium::index::map::SparseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
-//using index_type = osmium::index::map::DenseFileArray<osmium::unsigned_object_id_type, osmium::Location>;
+// The location cache can read dense and sparse cache files.
+using index_type = osmium::index::map::LocationCache<osmium::unsigned_object_id_type, osmium::Location>;
 
 // The location handler always depends on the index type
 using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
@@ -86,8 +84,8 @@ int main(int argc, char* argv[]) {
         // Construct Reader reading only ways
         osmium::io::Reader reader{input_filename, osmium::osm_entity_bits::way};
 
-        // Initialize location index on disk using an existing file
-        const int fd = ::open(cache_filename.c_str(), O_RDWR);
+        // Open the location cache file.
+        const int fd = ::open(cache_filename.c_str(), O_RDONLY);
         if (fd == -1) {
             std::cerr << "Can not open location cache file '" << cache_filename << "': " << std::strerror(errno) << "\n";
             return 1;
@@ -95,7 +93,21 @@ int main(int argc, char* argv[]) {
 #ifdef _WIN32
         _setmode(fd, _O_BINARY);
 #endif
+
+        // Map the location cache file into memory. This will fail if it is
+        // not a valid location cache file. The file can be closed after
+        // this.
         index_type index{fd};
+        ::close(fd);
+
+        // Check whether the cache was created from data with the same
+        // timestamp as the data we are reading now.
+        const std::string timestamp_str{reader.header().get("osmosis_replication_timestamp")};
+        const osmium::Timestamp timestamp{timestamp_str.empty() ? osmium::Timestamp{} : osmium::Timestamp{timestamp_str}};
+        if (timestamp != index.timestamp()) {
+            std::cerr << "Warning: Location cache was created from data with timestamp "
+                      << index.timestamp() << ", but input file has timestamp " << timestamp << "\n";
+        }
 
         // The handler that adds node locations from the index to the ways.
         location_handler_type location_handler{index};
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/area/stats.hpp>
+#include <osmium/memory/buffer.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/relation.hpp>
 #include <osmium/osm/tag.hpp>
@@ -48,9 +49,14 @@ DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -82,6 +88,117 @@ namespace osmium {
 
             osmium::TagsFilter m_filter;
 
+            enum {
+                initial_job_buffer_size = 128UL * 1024UL
+            };
+
+            enum {
+                max_job_size = 64UL * 1024UL
+            };
+
+            struct assembly_result {
+                osmium::memory::Buffer buffer;
+                area_stats stats;
+            }; // struct assembly_result
+
+            /**
+             * A batch of work for the thread pool. The input buffer contains
+             * closed ways to be assembled into areas and complete relations,
+             * each followed by copies of its member ways in member order.
+             */
+            class assembly_job {
+
+                assembler_config_type m_config;
+                osmium::memory::Buffer m_input;
+
+            public:
+
+                assembly_job(const assembler_config_type& config, osmium::memory::Buffer&& input) :
+                    m_config(config),
+                    m_input(std::move(input)) {
+                }
+
+                assembly_result operator()() {
+                    assembly_result result{osmium::memory::Buffer{m_input.committed(), osmium::memory::Buffer::auto_grow::yes}, area_stats{}};
+                    std::vector<const osmium::Way*> ways;
+
+                    const auto end = m_input.cend();
+                    for (auto it = m_input.cbegin(); it != end;) {
+                        try {
+                            if (it->type() == osmium::item_type::way) {
+                                TAssembler assembler{m_config};
+                                assembler(static_cast<const osmium::Way&>(*it++), result.buffer);
+                                result.stats += assembler.stats();
+                            } else {
+                                const auto& relation = static_cast<const osmium::Relation&>(*it++);
+                                ways.clear();
+                                for (const auto& member : relation.members()) {
+                                    if (member.ref() != 0) {
+                                        assert(it != end && it->type() == osmium::item_type::way);
+                                        ways.push_back(&static_cast<const osmium::Way&>(*it++));
+                                    }
+                                }
+                                TAssembler assembler{m_config};
+                                assembler(relation, ways, result.buffer);
+                                result.stats += assembler.stats();
+                            }
+                        } catch (const osmium::invalid_location&) {
+                            // XXX ignore
+                        }
+                    }
+
+                    return result;
+                }
+
+            }; // class assembly_job
+
+            // Submits a job to the thread pool, empty if no pool is used.
+            std::function<std::future<assembly_result>(assembly_job&&)> m_submit;
+
+            // Number of jobs that can be outstanding before waiting for
+            // the oldest one.
+            std::size_t m_max_outstanding = 0;
+
+            osmium::memory::Buffer m_job{initial_job_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+            std::deque<std::future<assembly_result>> m_results;
+
+            void add_result(assembly_result&& result) {
+                this->buffer().add_buffer(result.buffer);
+                this->buffer().commit();
+                m_stats += result.stats;
+                this->possibly_flush();
+            }
+
+            // Move results of finished jobs to the output buffer, keeping
+            // the order in which the jobs were submitted. Blocks until
+            // the number of outstanding jobs is at most max_outstanding.
+            void collect_results(std::size_t max_outstanding) {
+                while (!m_results.empty() &&
+                       (m_results.size() > max_outstanding ||
+                        m_results.front().wait_for(std::chrono::seconds{0}) == std::future_status::ready)) {
+                    auto future = std::move(m_results.front());
+                    m_results.pop_front();
+                    add_result(future.get());
+                }
+            }
+
+            void submit_job() {
+                if (m_job.committed() == 0) {
+                    return;
+                }
+                osmium::memory::Buffer input{initial_job_buffer_size, osmium::memory::Buffer::auto_grow::yes};
+                using std::swap;
+                swap(input, m_job);
+                m_results.push_back(m_submit(assembly_job{m_assembler_config, std::move(input)}));
+                collect_results(m_max_outstanding);
+            }
+
+            void possibly_submit_job() {
+                if (m_job.committed() >= max_job_size) {
+                    submit_job();
+                }
+            }
+
         public:
 
             /**
@@ -98,6 +215,57 @@ namespace osmium {
                 m_filter(std::move(filter)) {
             }
 
+            /**
+             * Assemble areas on the specified thread pool instead of on the
+             * thread calling the handler. Completed relations (with copies
+             * of their member ways) and closed ways are collected into
+             * batches which are assembled by the pool workers, each into
+             * its own buffer. The results are added to the output buffer
+             * in the same order as in the single-threaded mode, so the
+             * callback sees the same areas in the same order.
+             *
+             * Call this before the second pass. Results are added to the
+             * output buffer as batches finish, all outstanding batches are
+             * waited for in flush_output() and read(), so the output and the
+             * stats() are only complete after that.
+             *
+             * Note that the flush() function of the second pass handler
+             * calls flush_output() and with it waits for all batches.
+             * Because osmium::apply() calls flush() at the end of every
+             * call, using osmium::apply(buffer, ..., manager.handler())
+             * once per buffer limits the parallelism to a single buffer.
+             * Use osmium::apply(reader, ..., manager.handler()) instead, it
+             * only flushes once at the end of the input.
+             *
+             * The assembler configuration is copied into every worker task.
+             * If it contains a problem reporter, that reporter must be safe
+             * to use from several threads at once.
+             *
+             * @tparam TPool Usually osmium::thread::Pool. It must have the
+             *               functions submit() and num_threads(). The pool
+             *               must outlive the second pass.
+             */
+            template <typename TPool>
+            void use_thread_pool(TPool& pool) {
+                m_submit = [&pool](assembly_job&& job) {
+                    return pool.submit(std::move(job));
+                };
+                m_max_outstanding = 2 * static_cast<std::size_t>(pool.num_threads());
+            }
+
+            /**
+             * Wait for all outstanding assembly jobs and add their results to
+             * the output buffer. This is called automatically before the
+             * output is flushed or read. It does nothing if no thread pool
+             * is used.
+             */
+            void before_flush_output() {
+                if (m_submit) {
+                    submit_job();
+                    collect_results(0);
+                }
+            }
+
             /**
              * Access the aggregated statistics generated by the assemblers
              * called from the manager.
@@ -133,6 +301,23 @@ namespace osmium {
              * assembler.
              */
             void complete_relation(const osmium::Relation& relation) {
+                if (m_submit) {
+                    // The member ways are removed from the stash after this
+                    // function returns, so the job needs its own copies.
+                    m_job.add_item(relation);
+                    m_job.commit();
+                    for (const auto& member : relation.members()) {
+                        if (member.ref() != 0) {
+                            const osmium::Way* way = this->get_member_way(member.ref());
+                            assert(way != nullptr);
+                            m_job.add_item(*way);
+                            m_job.commit();
+                        }
+                    }
+                    possibly_submit_job();
+                    return;
+                }
+
                 std::vector<const osmium::Way*> ways;
                 ways.reserve(relation.members().size());
                 for (const auto& member : relation.members()) {
@@ -170,6 +355,13 @@ namespace osmium {
                             return;
                         }
 
+                        if (m_submit) {
+                            m_job.add_item(way);
+                            m_job.commit();
+                            possibly_submit_job();
+                            return;
+                        }
+
                         TAssembler assembler{m_assembler_config};
                         assembler(way, this->buffer());
                         m_stats += assembler.stats();
@@ -0,0 +1,433 @@
+#ifndef OSMIUM_EXTRACT_REFERENCE_COMPLETE_HPP
+#define OSMIUM_EXTRACT_REFERENCE_COMPLETE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <osmium/index/id_set_concurrent.hpp>
+#include <osmium/index/nwr_array.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * @brief Building blocks for creating extracts from OSM data
+     */
+    namespace extract {
+
+        /**
+         * Creates a reference-complete extract from an OSM file: All nodes
+         * of selected ways and all members of selected relations (and
+         * recursively their members) are added to the extract.
+         *
+         * Usage:
+         * 1. Mark the objects you want either directly in the id sets
+         *    returned by ids() or by calling select().
+         * 2. Call complete() to add all referenced objects.
+         * 3. Call write() to write all marked objects to a Writer.
+         *
+         * Each of these steps reads the input file (complete() reads it
+         * up to three times), so the input must be a file, not stdin. The
+         * buffers read are processed on the threads of the pool while
+         * the next buffers are read and decoded, all marks are kept in
+         * ConcurrentIdSetDense sets.
+         *
+         * The input file must be sorted by type (nodes, then ways, then
+         * relations) as OSM files usually are. If the header says the file
+         * is sorted by type and id or if assume_sorted() was called, the
+         * pass that only needs ways stops reading at the first relation.
+         *
+         * Ids are stored as positive ids, so negative ids are only
+         * supported if there are no positive ids with the same absolute
+         * value.
+         */
+        class ReferenceCompleteExtract {
+
+        public:
+
+            using id_set_type = osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type>;
+
+        private:
+
+            template <typename TFunc>
+            struct buffer_task {
+
+                osmium::memory::Buffer buffer;
+                TFunc* func;
+
+                osmium::memory::Buffer operator()() {
+                    return (*func)(buffer);
+                }
+
+            }; // struct buffer_task
+
+            osmium::io::File m_input;
+            osmium::thread::Pool& m_pool;
+            osmium::nwr_array<id_set_type> m_ids;
+            bool m_sorted;
+
+            static bool is_sorted(const osmium::io::File& file) {
+                osmium::io::Reader reader{file, osmium::osm_entity_bits::nothing};
+                const bool sorted = reader.header().get("sorting") == "Type_then_ID";
+                reader.close();
+                return sorted;
+            }
+
+            template <typename TFuture>
+            static void wait_for_all(std::deque<TFuture>& futures) noexcept {
+                for (auto& future : futures) {
+                    future.wait();
+                }
+            }
+
+            /**
+             * Read the input file and call func(buffer) for each buffer
+             * on the threads of the pool. The buffers returned from func
+             * are given to consume() on this thread in the order of the
+             * input. Before a buffer containing objects of a type not
+             * seen before is processed, all earlier buffers are finished,
+             * so func can rely on all marks for nodes being set when it
+             * sees the first way etc.
+             *
+             * If the file is sorted, reading stops after the first buffer
+             * containing an object in stop_at.
+             */
+            template <typename TFunc, typename TConsume>
+            void process(const osmium::osm_entity_bits::type entities,
+                         const osmium::osm_entity_bits::type stop_at,
+                         const osmium::io::read_meta read_metadata,
+                         TFunc& func,
+                         TConsume&& consume) {
+                const std::size_t max_in_flight = static_cast<std::size_t>(std::max(m_pool.num_threads(), 1)) * 2;
+
+                osmium::io::Reader reader{m_input, entities, read_metadata, m_pool};
+                std::deque<std::future<osmium::memory::Buffer>> futures;
+                osmium::item_type max_type = osmium::item_type::undefined;
+
+                try {
+                    while (osmium::memory::Buffer buffer = reader.read()) {
+                        bool stop = false;
+                        osmium::item_type last_type = max_type;
+                        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                            last_type = object.type();
+                            if (m_sorted && (stop_at & osmium::osm_entity_bits::from_item_type(last_type))) {
+                                stop = true;
+                            }
+                        }
+
+                        if (last_type > max_type) {
+                            max_type = last_type;
+                            while (!futures.empty()) {
+                                consume(futures.front().get());
+                                futures.pop_front();
+                            }
+                        }
+
+                        futures.push_back(m_pool.submit(buffer_task<TFunc>{std::move(buffer), &func}));
+
+                        while (futures.size() > max_in_flight) {
+                            consume(futures.front().get());
+                            futures.pop_front();
+                        }
+
+                        if (stop) {
+                            break;
+                        }
+                    }
+
+                    while (!futures.empty()) {
+                        consume(futures.front().get());
+                        futures.pop_front();
+                    }
+                } catch (...) {
+                    // The tasks access data owned by the caller, so we have
+                    // to wait for all of them before propagating the
+                    // exception.
+                    wait_for_all(futures);
+                    throw;
+                }
+
+                reader.close();
+            }
+
+            template <typename TFunc>
+            void process(const osmium::osm_entity_bits::type entities,
+                         const osmium::osm_entity_bits::type stop_at,
+                         TFunc& func) {
+                process(entities, stop_at, osmium::io::read_meta::no, func, [](osmium::memory::Buffer&& /*buffer*/) {});
+            }
+
+            void mark_members(const osmium::Relation& relation) {
+                for (const auto& member : relation.members()) {
+                    if (member.type() == osmium::item_type::node) {
+                        m_ids.nodes().set(member.positive_ref());
+                    } else if (member.type() == osmium::item_type::way) {
+                        m_ids.ways().set(member.positive_ref());
+                    }
+                }
+            }
+
+            // Mark the nodes and ways in all marked relations. Returns
+            // the (parent, child) pairs of all relation members.
+            std::vector<std::pair<osmium::unsigned_object_id_type, osmium::unsigned_object_id_type>> relations_pass() {
+                using edge = std::pair<osmium::unsigned_object_id_type, osmium::unsigned_object_id_type>;
+                std::vector<edge> edges;
+                std::mutex mutex;
+
+                auto func = [this, &edges, &mutex](const osmium::memory::Buffer& buffer) {
+                    std::vector<edge> local_edges;
+                    for (const auto& relation : buffer.select<osmium::Relation>()) {
+                        if (m_ids.relations().get(relation.positive_id())) {
+                            mark_members(relation);
+                        }
+                        for (const auto& member : relation.members()) {
+                            if (member.type() == osmium::item_type::relation) {
+                                local_edges.emplace_back(relation.positive_id(), member.positive_ref());
+                            }
+                        }
+                    }
+                    if (!local_edges.empty()) {
+                        const std::lock_guard<std::mutex> lock{mutex};
+                        edges.insert(edges.end(), local_edges.begin(), local_edges.end());
+                    }
+                    return osmium::memory::Buffer{};
+                };
+
+                process(osmium::osm_entity_bits::relation, osmium::osm_entity_bits::nothing, func);
+
+                return edges;
+            }
+
+        public:
+
+            /**
+             * Create extract.
+             *
+             * @param input The input file. It will be read several times.
+             * @param pool The thread pool used for decoding the input and
+             *             processing the data.
+             */
+            explicit ReferenceCompleteExtract(const osmium::io::File& input, osmium::thread::Pool& pool = osmium::thread::Pool::default_instance()) :
+                m_input(input),
+                m_pool(pool),
+                m_sorted(is_sorted(input)) {
+            }
+
+            /**
+             * Tell the extract that the input file is sorted by type and id
+             * even if the header does not say so.
+             */
+            void assume_sorted() noexcept {
+                m_sorted = true;
+            }
+
+            /**
+             * The id set with the marked objects of the given type. Add
+             * ids to these sets before calling complete().
+             */
+            id_set_type& ids(const osmium::item_type type) noexcept {
+                return m_ids(type);
+            }
+
+            const id_set_type& ids(const osmium::item_type type) const noexcept {
+                return m_ids(type);
+            }
+
+            /**
+             * Mark all objects for which predicate(object) returns true.
+             * Also mark all ways that have at least one marked node and all
+             * relations that have at least one marked node or way as
+             * member. This is what is needed for a region extract: Let
+             * the predicate return true for all nodes inside the region.
+             *
+             * The predicate is called from several threads at the same
+             * time and must be thread-safe.
+             *
+             * Reads the input file once.
+             */
+            template <typename TPredicate>
+            void select(TPredicate&& predicate) {
+                auto func = [this, &predicate](const osmium::memory::Buffer& buffer) {
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        const auto id = object.positive_id();
+                        bool marked = predicate(object);
+                        if (object.type() == osmium::item_type::way) {
+                            for (const auto& node_ref : static_cast<const osmium::Way&>(object).nodes()) {
+                                if (marked) {
+                                    break;
+                                }
+                                marked = m_ids.nodes().get(node_ref.positive_ref());
+                            }
+                        } else if (object.type() == osmium::item_type::relation) {
+                            for (const auto& member : static_cast<const osmium::Relation&>(object).members()) {
+                                if (marked) {
+                                    break;
+                                }
+                                if (member.type() == osmium::item_type::node || member.type() == osmium::item_type::way) {
+                                    marked = m_ids(member.type()).get(member.positive_ref());
+                                }
+                            }
+                        }
+                        if (marked) {
+                            m_ids(object.type()).set(id);
+                        }
+                    }
+                    return osmium::memory::Buffer{};
+                };
+
+                process(osmium::osm_entity_bits::nwr, osmium::osm_entity_bits::nothing, func);
+            }
+
+            /**
+             * Mark all members of marked relations, recursively. Reads the
+             * relations in the input file once or, if there are nested
+             * relations, twice.
+             */
+            void complete_relations() {
+                auto edges = relations_pass();
+
+                // Mark member relations of marked relations until nothing
+                // changes any more. Relation hierarchies are shallow, so
+                // this doesn't need many rounds.
+                std::sort(edges.begin(), edges.end());
+                edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+                bool found_new = false;
+                bool changed = true;
+                while (changed) {
+                    changed = false;
+                    for (const auto& e : edges) {
+                        if (m_ids.relations().get(e.first) && m_ids.relations().check_and_set(e.second)) {
+                            changed = true;
+                            found_new = true;
+                        }
+                    }
+                }
+
+                if (found_new) {
+                    relations_pass();
+                }
+            }
+
+            /**
+             * Mark all nodes of marked ways. Reads the ways in the input
+             * file once.
+             */
+            void complete_ways() {
+                auto func = [this](const osmium::memory::Buffer& buffer) {
+                    for (const auto& way : buffer.select<osmium::Way>()) {
+                        if (m_ids.ways().get(way.positive_id())) {
+                            for (const auto& node_ref : way.nodes()) {
+                                m_ids.nodes().set(node_ref.positive_ref());
+                            }
+                        }
+                    }
+                    return osmium::memory::Buffer{};
+                };
+
+                process(osmium::osm_entity_bits::way | osmium::osm_entity_bits::relation,
+                        osmium::osm_entity_bits::relation,
+                        func);
+            }
+
+            /**
+             * Mark all objects referenced from marked objects. Relations
+             * have to be done first, because they can reference ways.
+             */
+            void complete() {
+                complete_relations();
+                complete_ways();
+            }
+
+            /**
+             * Get the header of the input file. Use this as the basis for
+             * the header of the output file.
+             */
+            osmium::io::Header header() const {
+                osmium::io::Reader reader{m_input, osmium::osm_entity_bits::nothing};
+                osmium::io::Header header{reader.header()};
+                reader.close();
+                return header;
+            }
+
+            /**
+             * Write all marked objects to the writer in the order of the
+             * input file. The writer is not closed. Reads the input file
+             * once.
+             */
+            void write(osmium::io::Writer& writer) {
+                auto func = [this](const osmium::memory::Buffer& buffer) {
+                    osmium::memory::Buffer out{buffer.committed(), osmium::memory::Buffer::auto_grow::yes};
+                    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                        if (m_ids(object.type()).get(object.positive_id())) {
+                            out.add_item(object);
+                            out.commit();
+                        }
+                    }
+                    return out;
+                };
+
+                process(osmium::osm_entity_bits::nwr,
+                        osmium::osm_entity_bits::nothing,
+                        osmium::io::read_meta::yes,
+                        func,
+                        [&writer](osmium::memory::Buffer&& buffer) {
+                            if (buffer.committed() > 0) {
+                                writer(std::move(buffer));
+                            }
+                        });
+            }
+
+        }; // class ReferenceCompleteExtract
+
+    } // namespace extract
+
+} // namespace osmium
+
+#endif // OSMIUM_EXTRACT_REFERENCE_COMPLETE_HPP
@@ -0,0 +1,126 @@
+#ifndef OSMIUM_HANDLER_CHECK_LOCATIONS_ON_WAYS_HPP
+#define OSMIUM_HANDLER_CHECK_LOCATIONS_ON_WAYS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <osmium/handler.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/osm/node_ref.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace osmium {
+
+    namespace handler {
+
+        /**
+         * Handler that checks that ways have the locations of their nodes
+         * set. Use this instead of the NodeLocationsForWays handler when
+         * reading a file that already has the locations on the ways, for
+         * instance a PBF file with the "LocationsOnWays" feature. (In that
+         * case the header option "locations_on_ways" is set to "true".)
+         *
+         * Checking all ways costs some time, so by default only every
+         * 1000th way is checked. That is enough to detect files without
+         * locations on ways.
+         *
+         * @code
+         * osmium::io::Reader reader{filename};
+         * if (reader.header().is_true("locations_on_ways")) {
+         *     osmium::handler::CheckLocationsOnWays check;
+         *     osmium::apply(reader, check, handler);
+         * } else {
+         *     osmium::apply(reader, location_handler, handler);
+         * }
+         * @endcode
+         */
+        class CheckLocationsOnWays : public osmium::handler::Handler {
+
+            std::size_t m_sample_interval;
+            std::size_t m_count = 0;
+            std::size_t m_checked = 0;
+
+        public:
+
+            enum : std::size_t {
+                default_sample_interval = 1000
+            };
+
+            /**
+             * Create handler.
+             *
+             * @param sample_interval Check every sample_interval-th way.
+             *                        Set to 1 to check all ways. The first
+             *                        way is always checked.
+             */
+            explicit CheckLocationsOnWays(const std::size_t sample_interval = default_sample_interval) noexcept :
+                m_sample_interval(sample_interval == 0 ? 1 : sample_interval) {
+            }
+
+            /**
+             * Check the way if it is one of the sampled ways.
+             *
+             * @throws osmium::not_found if a node of a checked way has
+             *         no valid location.
+             */
+            void way(const osmium::Way& way) {
+                if (m_count++ % m_sample_interval != 0) {
+                    return;
+                }
+
+                ++m_checked;
+                for (const auto& node_ref : way.nodes()) {
+                    if (!node_ref.location().valid()) {
+                        throw osmium::not_found{"way " + std::to_string(way.id()) + " has no location for node " + std::to_string(node_ref.ref())};
+                    }
+                }
+            }
+
+            /// The number of ways seen.
+            std::size_t count() const noexcept {
+                return m_count;
+            }
+
+            /// The number of ways checked.
+            std::size_t checked() const noexcept {
+                return m_checked;
+            }
+
+        }; // class CheckLocationsOnWays
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_CHECK_LOCATIONS_ON_WAYS_HPP
@@ -34,17 +34,23 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/handler.hpp>
+#include <osmium/index/id_set.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/map/dummy.hpp>
 #include <osmium/index/node_locations_map.hpp>
+#include <osmium/memory/buffer.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/node.hpp>
 #include <osmium/osm/node_ref.hpp>
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <limits>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -52,6 +58,13 @@ namespace osmium {
 
         using dummy_type = osmium::index::map::Dummy<osmium::unsigned_object_id_type, osmium::Location>;
 
+        namespace detail {
+
+            template <typename TStoragePosIDs, typename TStorageNegIDs>
+            struct node_locations_for_ways_parallel;
+
+        } // namespace detail
+
         /**
          * Handler to retrieve locations from nodes and add them to ways.
          *
@@ -69,6 +82,8 @@ namespace osmium {
             static_assert(based_on_map<TStoragePosIDs>::value, "Index class must be derived from osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>");
             static_assert(based_on_map<TStorageNegIDs>::value, "Index class must be derived from osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>");
 
+            friend struct detail::node_locations_for_ways_parallel<TStoragePosIDs, TStorageNegIDs>;
+
         public:
 
             using index_pos_type = TStoragePosIDs;
@@ -88,6 +103,154 @@ namespace osmium {
 
             bool m_must_sort = false;
 
+            // If set, only the locations of nodes in this set are stored.
+            const osmium::index::IdSet<osmium::unsigned_object_id_type>* m_needed_nodes = nullptr;
+
+            // Buffers used for the index lookups. They are only kept so
+            // that they don't have to be allocated for every way.
+            struct lookup_buffers {
+                std::vector<std::pair<osmium::unsigned_object_id_type, std::size_t>> lookup;
+                std::vector<osmium::unsigned_object_id_type> ids;
+                std::vector<osmium::Location> locations;
+            }; // struct lookup_buffers
+
+            lookup_buffers m_lookup_buffers;
+
+            // A node ref waiting for its location in join_ways().
+            struct join_entry {
+                osmium::unsigned_object_id_type id;
+                osmium::NodeRef* node_ref;
+
+                bool operator<(const join_entry& other) const noexcept {
+                    return id < other.id;
+                }
+            }; // struct join_entry
+
+            // Used in join_ways(). Only kept here so that they don't have
+            // to be allocated for every batch.
+            std::vector<join_entry> m_join_pos;
+            std::vector<join_entry> m_join_neg;
+
+            // Number of node refs to look ahead in ways().
+            std::size_t m_prefetch_distance = default_prefetch_distance;
+
+            void sort_if_needed() {
+                if (m_must_sort) {
+                    m_storage_pos.sort();
+                    m_storage_neg.sort();
+                    m_must_sort = false;
+                    m_last_id = std::numeric_limits<osmium::unsigned_object_id_type>::max();
+                }
+            }
+
+            void prefetch_way(const osmium::Way& way) const noexcept {
+                for (const auto& node_ref : way.nodes()) {
+                    const auto id = node_ref.ref();
+                    if (id >= 0) {
+                        m_storage_pos.prefetch(static_cast<osmium::unsigned_object_id_type>(id));
+                    } else {
+                        m_storage_neg.prefetch(static_cast<osmium::unsigned_object_id_type>(-id));
+                    }
+                }
+            }
+
+            // Look up the locations of all nodes in the way and add them
+            // to the way. Only reads from the indexes, so this can be
+            // called from several threads at the same time with different
+            // lookup buffers.
+            void resolve_way(osmium::Way& way, lookup_buffers& buffers) const {
+                auto& nodes = way.nodes();
+
+                // Collect all positive Ids together with their position in
+                // the way and sort them, so the index can look them up in
+                // one go.
+                buffers.lookup.clear();
+                for (std::size_t n = 0; n < nodes.size(); ++n) {
+                    const auto id = nodes[n].ref();
+                    if (id >= 0) {
+                        buffers.lookup.emplace_back(static_cast<osmium::unsigned_object_id_type>(id), n);
+                    } else {
+                        nodes[n].set_location(m_storage_neg.get_noexcept(static_cast<osmium::unsigned_object_id_type>(-id)));
+                    }
+                }
+                std::sort(buffers.lookup.begin(), buffers.lookup.end());
+
+                buffers.ids.resize(buffers.lookup.size());
+                buffers.locations.resize(buffers.lookup.size());
+                for (std::size_t i = 0; i < buffers.lookup.size(); ++i) {
+                    buffers.ids[i] = buffers.lookup[i].first;
+                }
+                m_storage_pos.get_noexcept_bulk(buffers.ids.data(), buffers.ids.size(), buffers.locations.data());
+                for (std::size_t i = 0; i < buffers.lookup.size(); ++i) {
+                    nodes[buffers.lookup[i].second].set_location(buffers.locations[i]);
+                }
+
+                bool error = false;
+                for (const auto& node_ref : nodes) {
+                    if (!node_ref.location()) {
+                        error = true;
+                    }
+                }
+                if (!m_ignore_errors && error) {
+                    throw osmium::not_found{"location for one or more nodes not found in node location index"};
+                }
+            }
+
+            // Resolve all ways in the range [first, last). While working on
+            // one way, prefetch the locations for the node refs in the next
+            // ways. The current way itself is not prefetched here, the bulk
+            // lookup in resolve_way() already does that.
+            template <typename TIter>
+            void resolve_ways(TIter first, TIter last, lookup_buffers& buffers) const {
+                // Iterator to the next way that hasn't been prefetched yet
+                // and number of node refs in the ways after the current one
+                // that were prefetched.
+                auto ahead = first;
+                std::size_t num_prefetched = 0;
+
+                for (; first != last; ++first) {
+                    osmium::Way& way = *first;
+                    if (ahead == first) {
+                        ++ahead;
+                    } else {
+                        num_prefetched -= way.nodes().size();
+                    }
+                    while (ahead != last && num_prefetched < m_prefetch_distance) {
+                        const osmium::Way& ahead_way = *ahead;
+                        prefetch_way(ahead_way);
+                        num_prefetched += ahead_way.nodes().size();
+                        ++ahead;
+                    }
+                    resolve_way(way, buffers);
+                }
+            }
+
+            // Sort the entries by id, look up the location of each
+            // distinct id in one bulk call, and set the locations in the
+            // node refs.
+            template <typename TStorage>
+            static void join(std::vector<join_entry>& entries, const TStorage& storage, lookup_buffers& buffers) {
+                std::sort(entries.begin(), entries.end());
+
+                buffers.ids.clear();
+                for (const auto& entry : entries) {
+                    if (buffers.ids.empty() || buffers.ids.back() != entry.id) {
+                        buffers.ids.push_back(entry.id);
+                    }
+                }
+
+                buffers.locations.resize(buffers.ids.size());
+                storage.get_noexcept_bulk(buffers.ids.data(), buffers.ids.size(), buffers.locations.data());
+
+                std::size_t i = 0;
+                for (const auto& entry : entries) {
+                    while (buffers.ids[i] != entry.id) {
+                        ++i;
+                    }
+                    entry.node_ref->set_location(buffers.locations[i]);
+                }
+            }
+
             // It is okay to have this static dummy instance, even when using several threads,
             // because it is read-only.
             static dummy_type& get_dummy() {
@@ -97,6 +260,10 @@ namespace osmium {
 
         public:
 
+            enum : std::size_t {
+                default_prefetch_distance = 64
+            };
+
             explicit NodeLocationsForWays(TStoragePosIDs& storage_pos,
                                           TStorageNegIDs& storage_neg = get_dummy()) noexcept :
                 m_storage_pos(storage_pos),
@@ -123,10 +290,32 @@ namespace osmium {
                 return m_storage_neg;
             }
 
+            /**
+             * Only store the locations of nodes with ids in the given set.
+             * Use this if only the locations of some nodes are needed, for
+             * instance because only some of the ways are of interest. The
+             * set can be built in a first pass over the ways with
+             * collect_needed_nodes() from
+             * osmium/handler/node_locations_for_ways_parallel.hpp. Ways
+             * with other nodes will then, of course, not get all their
+             * locations.
+             *
+             * The set is keyed by positive ids (the absolute value for
+             * negative ids). It must outlive this handler or be reset
+             * by calling this function with nullptr.
+             */
+            void only_store_nodes(const osmium::index::IdSet<osmium::unsigned_object_id_type>* needed_nodes) noexcept {
+                m_needed_nodes = needed_nodes;
+            }
+
             /**
              * Store the location of the node in the storage.
              */
             void node(const osmium::Node& node) {
+                if (m_needed_nodes && !m_needed_nodes->get(node.positive_id())) {
+                    return;
+                }
+
                 if (node.positive_id() < m_last_id) {
                     m_must_sort = true;
                 }
@@ -155,24 +344,115 @@ namespace osmium {
              * them to the way object.
              */
             void way(osmium::Way& way) {
-                if (m_must_sort) {
-                    m_storage_pos.sort();
-                    m_storage_neg.sort();
-                    m_must_sort = false;
-                    m_last_id = std::numeric_limits<osmium::unsigned_object_id_type>::max();
-                }
-                bool error = false;
-                for (auto& node_ref : way.nodes()) {
-                    node_ref.set_location(get_node_location(node_ref.ref()));
-                    if (!node_ref.location()) {
-                        error = true;
+                sort_if_needed();
+                resolve_way(way, m_lookup_buffers);
+            }
+
+            /**
+             * Set the number of node refs in the following ways that ways()
+             * will prefetch. Set to 0 to disable prefetching of following
+             * ways. (The index can still prefetch the node refs of the way
+             * it is currently looking up.)
+             */
+            void set_prefetch_distance(const std::size_t distance) noexcept {
+                m_prefetch_distance = distance;
+            }
+
+            /**
+             * Retrieve locations of all nodes in the ways in the range
+             * [first, last) from storage and add them to the way objects.
+             * This does the same as calling way() for each of the ways,
+             * but while working on one way, it tells the index to prefetch
+             * the locations for the node refs in the next ways (up to the
+             * prefetch distance set with set_prefetch_distance()). This
+             * can make a huge difference for large dense indexes where
+             * every lookup is likely a cache miss.
+             *
+             * @code
+             * location_handler.ways(buffer.select<osmium::Way>().begin(),
+             *                       buffer.select<osmium::Way>().end());
+             * @endcode
+             *
+             * @tparam TIter Iterator type, dereferencing must result in an
+             *               osmium::Way&.
+             */
+            template <typename TIter>
+            void ways(TIter first, TIter last) {
+                sort_if_needed();
+                resolve_ways(first, last, m_lookup_buffers);
+            }
+
+            /**
+             * Retrieve locations of all nodes in the ways in the range
+             * [first, last) from storage and add them to the way objects.
+             * This does the same as calling way() for each of the ways,
+             * but instead of looking up the node refs way by way, it
+             * collects the node refs of all ways, sorts them by id, looks
+             * up each distinct id once in order of increasing ids and
+             * then writes the locations back into the ways.
+             *
+             * Use this with large batches of ways (a buffer or more) and
+             * indexes that don't fit into memory, such as DenseFileArray
+             * or SparseFileArray. The index is then read sequentially
+             * instead of with random accesses. This needs 16 bytes of
+             * temporary memory per node ref.
+             *
+             * @tparam TIter Iterator type, dereferencing must result in an
+             *               osmium::Way&.
+             * @throws osmium::not_found If a location is not found, unless
+             *         ignore_errors() was called.
+             */
+            template <typename TIter>
+            void join_ways(TIter first, TIter last) {
+                sort_if_needed();
+
+                m_join_pos.clear();
+                m_join_neg.clear();
+                for (auto it = first; it != last; ++it) {
+                    osmium::Way& way = *it;
+                    for (auto& node_ref : way.nodes()) {
+                        const auto id = node_ref.ref();
+                        if (id >= 0) {
+                            m_join_pos.push_back(join_entry{static_cast<osmium::unsigned_object_id_type>(id), &node_ref});
+                        } else {
+                            m_join_neg.push_back(join_entry{static_cast<osmium::unsigned_object_id_type>(-id), &node_ref});
+                        }
                     }
                 }
-                if (!m_ignore_errors && error) {
+
+                join(m_join_pos, m_storage_pos, m_lookup_buffers);
+                join(m_join_neg, m_storage_neg, m_lookup_buffers);
+
+                if (m_ignore_errors) {
+                    return;
+                }
+
+                const auto missing = [](const join_entry& entry) {
+                    return !entry.node_ref->location();
+                };
+                if (std::any_of(m_join_pos.begin(), m_join_pos.end(), missing) ||
+                    std::any_of(m_join_neg.begin(), m_join_neg.end(), missing)) {
                     throw osmium::not_found{"location for one or more nodes not found in node location index"};
                 }
             }
 
+            /**
+             * Store the locations of all nodes in the buffer and then add
+             * the node locations to all ways in the buffer using
+             * join_ways(). Nodes in the buffer are handled before ways,
+             * so the input must be sorted by type.
+             *
+             * @throws osmium::not_found If a location is not found, unless
+             *         ignore_errors() was called.
+             */
+            void join_buffer(osmium::memory::Buffer& buffer) {
+                for (const auto& node : buffer.select<osmium::Node>()) {
+                    this->node(node);
+                }
+                auto ways = buffer.select<osmium::Way>();
+                join_ways(ways.begin(), ways.end());
+            }
+
             /**
              * Call clear on the location indexes. Makes the
              * NodeLocationsForWays handler unusable. Used to explicitly free
@@ -0,0 +1,201 @@
+#ifndef OSMIUM_HANDLER_NODE_LOCATIONS_FOR_WAYS_PARALLEL_HPP
+#define OSMIUM_HANDLER_NODE_LOCATIONS_FOR_WAYS_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/id_set_concurrent.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace osmium {
+
+    namespace handler {
+
+        namespace detail {
+
+            // Minimum number of ways handled in one task.
+            enum : std::size_t {
+                min_ways_per_task = 256
+            };
+
+            // Split the ways into chunks and call func(first, last) for
+            // each chunk on the threads of the pool.
+            template <typename TWays, typename TFunc>
+            void for_each_way_chunk(osmium::thread::Pool& pool, TWays& ways, TFunc&& func) {
+                const std::size_t num_chunks = std::min(ways.size() / min_ways_per_task + 1,
+                                                        static_cast<std::size_t>(std::max(pool.num_threads(), 1)) * 4);
+                const std::size_t chunk_size = (ways.size() + num_chunks - 1) / num_chunks;
+
+                osmium::thread::run_in_parallel(pool, num_chunks, [&ways, &func, chunk_size](const std::size_t n) {
+                    const auto first = ways.begin() + static_cast<std::ptrdiff_t>(std::min(n * chunk_size, ways.size()));
+                    const auto last = ways.begin() + static_cast<std::ptrdiff_t>(std::min((n + 1) * chunk_size, ways.size()));
+                    func(first, last);
+                });
+            }
+
+            template <typename TStoragePosIDs, typename TStorageNegIDs>
+            struct node_locations_for_ways_parallel {
+
+                using handler_type = NodeLocationsForWays<TStoragePosIDs, TStorageNegIDs>;
+                using lookup_buffers = typename handler_type::lookup_buffers;
+                using way_vector = std::vector<std::reference_wrapper<osmium::Way>>;
+
+                static void process_buffer(handler_type& handler, osmium::memory::Buffer& buffer, osmium::thread::Pool& pool) {
+                    way_vector ways;
+                    for (auto& item : buffer) {
+                        if (item.type() == osmium::item_type::node) {
+                            handler.node(static_cast<const osmium::Node&>(item));
+                        } else if (item.type() == osmium::item_type::way) {
+                            ways.emplace_back(static_cast<osmium::Way&>(item));
+                        }
+                    }
+
+                    if (ways.empty()) {
+                        return;
+                    }
+
+                    handler.sort_if_needed();
+
+                    const handler_type& const_handler = handler;
+                    for_each_way_chunk(pool, ways, [&const_handler](typename way_vector::iterator first,
+                                                                    typename way_vector::iterator last) {
+                        lookup_buffers buffers;
+                        const_handler.resolve_ways(first, last, buffers);
+                    });
+                }
+
+            }; // struct node_locations_for_ways_parallel
+
+        } // namespace detail
+
+        /**
+         * Store the locations of all nodes in the buffer and add the node
+         * locations to all ways in the buffer. The nodes are stored on
+         * this thread, the ways are then split into chunks which are
+         * resolved in parallel on the threads of the pool. This only reads
+         * from the indexes, which all indexes support from several threads
+         * at the same time. When called for all buffers from a Reader,
+         * this does the same as applying the location handler to them.
+         *
+         * @code
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     osmium::handler::process_buffer(location_handler, buffer, pool);
+         *     osmium::apply(buffer, handler);
+         * }
+         * @endcode
+         *
+         * Do not call this from inside a task running in the same pool.
+         *
+         * @param location_handler The handler storing the node locations.
+         * @param buffer The buffer with the nodes and ways. Nodes in the
+         *               buffer are handled before ways, so the input must
+         *               be sorted by type.
+         * @param pool The thread pool used for resolving the ways.
+         * @throws osmium::not_found If a location is not found, unless
+         *         ignore_errors() was called on the location handler.
+         */
+        template <typename TStoragePosIDs, typename TStorageNegIDs>
+        void process_buffer(NodeLocationsForWays<TStoragePosIDs, TStorageNegIDs>& location_handler,
+                            osmium::memory::Buffer& buffer,
+                            osmium::thread::Pool& pool) {
+            detail::node_locations_for_ways_parallel<TStoragePosIDs, TStorageNegIDs>::process_buffer(location_handler, buffer, pool);
+        }
+
+        /**
+         * Add the ids of all nodes of ways in the buffer for which
+         * predicate(way) returns true to the set. The ways are split into
+         * chunks which are checked on the threads of the pool. Use this
+         * in a first pass over the ways to build the set of nodes needed
+         * for NodeLocationsForWays::only_store_nodes().
+         *
+         * @code
+         * osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> needed_nodes;
+         * osmium::io::Reader reader{filename, osmium::osm_entity_bits::way};
+         * while (osmium::memory::Buffer buffer = reader.read()) {
+         *     osmium::handler::collect_needed_nodes(buffer, pool, needed_nodes, [](const osmium::Way& way) {
+         *         return way.tags().has_key("highway");
+         *     });
+         * }
+         * @endcode
+         *
+         * Do not call this from inside a task running in the same pool.
+         *
+         * @param buffer Buffer with the ways. Other objects are ignored.
+         * @param pool The thread pool to use.
+         * @param ids The set the node ids are added to. The ids are
+         *            stored as positive ids.
+         * @param predicate Called with each way from several threads at
+         *                  the same time, so it must be thread-safe.
+         */
+        template <typename TPredicate>
+        void collect_needed_nodes(const osmium::memory::Buffer& buffer,
+                                  osmium::thread::Pool& pool,
+                                  osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type>& ids,
+                                  TPredicate&& predicate) {
+            std::vector<const osmium::Way*> ways;
+            for (const auto& way : buffer.select<osmium::Way>()) {
+                ways.push_back(&way);
+            }
+
+            if (ways.empty()) {
+                return;
+            }
+
+            detail::for_each_way_chunk(pool, ways, [&ids, &predicate](std::vector<const osmium::Way*>::iterator first,
+                                                                      std::vector<const osmium::Way*>::iterator last) {
+                for (; first != last; ++first) {
+                    if (predicate(**first)) {
+                        for (const auto& node_ref : (*first)->nodes()) {
+                            ids.set(node_ref.positive_ref());
+                        }
+                    }
+                }
+            });
+        }
+
+    } // namespace handler
+
+} // namespace osmium
+
+#endif // OSMIUM_HANDLER_NODE_LOCATIONS_FOR_WAYS_PARALLEL_HPP
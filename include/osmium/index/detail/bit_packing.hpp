@@ -0,0 +1,156 @@
+#ifndef OSMIUM_INDEX_DETAIL_BIT_PACKING_HPP
+#define OSMIUM_INDEX_DETAIL_BIT_PACKING_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Number of bits needed to store the given unsigned value.
+             * Returns 0 for the value 0.
+             */
+            inline unsigned int bits_needed(uint64_t value) noexcept {
+                unsigned int bits = 0;
+                while (value != 0) {
+                    ++bits;
+                    value >>= 1U;
+                }
+                return bits;
+            }
+
+            /**
+             * Number of bits set in the value.
+             */
+            inline unsigned int popcount(uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_popcountll(value));
+#else
+                unsigned int count = 0;
+                while (value != 0) {
+                    value &= value - 1;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
+            /**
+             * Number of trailing zero bits in the value.
+             *
+             * @pre value != 0
+             */
+            inline unsigned int count_trailing_zeros(uint64_t value) noexcept {
+                assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+                return static_cast<unsigned int>(__builtin_ctzll(value));
+#else
+                unsigned int count = 0;
+                while ((value & 1U) == 0) {
+                    value >>= 1U;
+                    ++count;
+                }
+                return count;
+#endif
+            }
+
+            /**
+             * Append the lowest width bits of value to the bit stream in
+             * words starting at bit position pos. The words vector will be
+             * extended as needed. Bits must be written in order, because
+             * the new bits are OR'ed into the (zero-initialized) words.
+             *
+             * @pre width <= 64
+             * @pre value < 2^width
+             */
+            inline void write_bits(std::vector<uint64_t>& words, const uint64_t pos, const uint64_t value, const unsigned int width) {
+                assert(width <= 64);
+                if (width == 0) {
+                    return;
+                }
+
+                const auto word = static_cast<std::size_t>(pos >> 6U);
+                const auto shift = static_cast<unsigned int>(pos & 63U);
+                const auto needed = static_cast<std::size_t>((pos + width + 63U) >> 6U);
+                if (words.size() < needed) {
+                    words.resize(needed, 0);
+                }
+
+                words[word] |= value << shift;
+                if (shift + width > 64) {
+                    words[word + 1] |= value >> (64U - shift);
+                }
+            }
+
+            /**
+             * Read width bits from the bit stream in words starting at bit
+             * position pos.
+             *
+             * @pre width <= 64
+             */
+            inline uint64_t read_bits(const uint64_t* words, const uint64_t pos, const unsigned int width) noexcept {
+                assert(width <= 64);
+                if (width == 0) {
+                    return 0;
+                }
+
+                const auto word = static_cast<std::size_t>(pos >> 6U);
+                const auto shift = static_cast<unsigned int>(pos & 63U);
+
+                uint64_t value = words[word] >> shift;
+                if (shift + width > 64) {
+                    value |= words[word + 1] << (64U - shift);
+                }
+
+                if (width < 64) {
+                    value &= (1ULL << width) - 1U;
+                }
+
+                return value;
+            }
+
+        } // namespace detail
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_BIT_PACKING_HPP
@@ -0,0 +1,181 @@
+#ifndef OSMIUM_INDEX_DETAIL_PARALLEL_SORT_HPP
+#define OSMIUM_INDEX_DETAIL_PARALLEL_SORT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            enum : std::size_t {
+                // Ranges smaller than this are sorted in the current thread.
+                parallel_sort_min_size = 1U << 16U,
+
+                // Number of bits of the key used for partitioning the data.
+                parallel_sort_radix_bits = 10U
+            };
+
+            /**
+             * Sort the range [first, last) using the threads in the pool.
+             *
+             * In a first pass the elements are distributed into up to 1024
+             * buckets according to the highest bits of their key (a radix
+             * partitioning step). Counting the bucket sizes and moving the
+             * elements is done in parallel on chunks of the input. Then the
+             * buckets are sorted in parallel with std::sort() and copied
+             * back. This works well if the keys are somewhat evenly
+             * distributed, which is the case for OSM object Ids.
+             *
+             * Needs temporary memory of the same size as the input range.
+             *
+             * Do not call this from a task running in the same pool.
+             *
+             * @param first Beginning of the range.
+             * @param last End of the range.
+             * @param get_key Function returning an unsigned integer key for
+             *                an element. Must be compatible with the sort
+             *                order, ie if a < b then get_key(a) <= get_key(b).
+             * @param pool The thread pool to use.
+             * @param compare Comparison function used for sorting.
+             *
+             * @tparam TIter Random access iterator. The value type must be
+             *               default constructible and copyable.
+             */
+            template <typename TIter, typename TGetKey, typename TCompare>
+            void parallel_sort(TIter first, TIter last, TGetKey&& get_key, osmium::thread::Pool& pool, TCompare compare) {
+                using value_type = typename std::iterator_traits<TIter>::value_type;
+
+                const auto size = static_cast<std::size_t>(std::distance(first, last));
+                const auto num_chunks = static_cast<std::size_t>(pool.num_threads());
+
+                if (size < parallel_sort_min_size || num_chunks < 2) {
+                    std::sort(first, last, compare);
+                    return;
+                }
+
+                const std::size_t chunk_size = (size + num_chunks - 1) / num_chunks;
+                const auto chunk_begin = [&](const std::size_t chunk) {
+                    return first + static_cast<std::ptrdiff_t>(std::min(chunk * chunk_size, size));
+                };
+
+                // Find the largest key to figure out which bits to use for
+                // partitioning.
+                std::vector<uint64_t> max_keys(num_chunks, 0);
+                osmium::thread::run_in_parallel(pool, num_chunks, [&](const std::size_t chunk) {
+                    uint64_t max_key = 0;
+                    for (auto it = chunk_begin(chunk); it != chunk_begin(chunk + 1); ++it) {
+                        max_key = std::max(max_key, static_cast<uint64_t>(get_key(*it)));
+                    }
+                    max_keys[chunk] = max_key;
+                });
+                const uint64_t max_key = *std::max_element(max_keys.cbegin(), max_keys.cend());
+                const unsigned int key_bits = bits_needed(max_key);
+                const unsigned int shift = key_bits > parallel_sort_radix_bits ? key_bits - parallel_sort_radix_bits : 0;
+                const auto num_buckets = static_cast<std::size_t>(max_key >> shift) + 1;
+
+                const auto bucket = [&](const value_type& value) {
+                    return static_cast<std::size_t>(static_cast<uint64_t>(get_key(value)) >> shift);
+                };
+
+                // Count elements per bucket in each chunk...
+                std::vector<std::size_t> positions(num_chunks * num_buckets, 0);
+                osmium::thread::run_in_parallel(pool, num_chunks, [&](const std::size_t chunk) {
+                    std::size_t* counts = &positions[chunk * num_buckets];
+                    for (auto it = chunk_begin(chunk); it != chunk_begin(chunk + 1); ++it) {
+                        ++counts[bucket(*it)];
+                    }
+                });
+
+                // ...and turn those counts into the positions where each
+                // chunk will write the elements of each bucket.
+                std::vector<std::size_t> bucket_begin(num_buckets + 1);
+                std::size_t pos = 0;
+                for (std::size_t b = 0; b < num_buckets; ++b) {
+                    bucket_begin[b] = pos;
+                    for (std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                        const std::size_t count = positions[chunk * num_buckets + b];
+                        positions[chunk * num_buckets + b] = pos;
+                        pos += count;
+                    }
+                }
+                bucket_begin[num_buckets] = pos;
+
+                const std::unique_ptr<value_type[]> tmp{new value_type[size]};
+                osmium::thread::run_in_parallel(pool, num_chunks, [&](const std::size_t chunk) {
+                    std::size_t* next = &positions[chunk * num_buckets];
+                    for (auto it = chunk_begin(chunk); it != chunk_begin(chunk + 1); ++it) {
+                        tmp[next[bucket(*it)]++] = *it;
+                    }
+                });
+
+                osmium::thread::run_in_parallel(pool, num_buckets, [&](const std::size_t b) {
+                    value_type* begin = tmp.get() + bucket_begin[b];
+                    value_type* end = tmp.get() + bucket_begin[b + 1];
+                    std::sort(begin, end, compare);
+                    std::copy(begin, end, first + static_cast<std::ptrdiff_t>(bucket_begin[b]));
+                });
+            }
+
+            /**
+             * Sort the range [first, last) using the threads in the pool.
+             * Like the other parallel_sort() function, but uses operator<
+             * for sorting.
+             */
+            template <typename TIter, typename TGetKey>
+            void parallel_sort(TIter first, TIter last, TGetKey&& get_key, osmium::thread::Pool& pool) {
+                using value_type = typename std::iterator_traits<TIter>::value_type;
+                parallel_sort(first, last, std::forward<TGetKey>(get_key), pool, [](const value_type& a, const value_type& b) {
+                    return a < b;
+                });
+            }
+
+        } // namespace detail
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_PARALLEL_SORT_HPP
@@ -0,0 +1,86 @@
+#ifndef OSMIUM_INDEX_DETAIL_SEARCH_HPP
+#define OSMIUM_INDEX_DETAIL_SEARCH_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Find the first element in the sorted range [first, last) for
+             * which the key is not less than the given key. This does the
+             * same as std::lower_bound(), but it starts looking at the
+             * beginning of the range with exponentially increasing step
+             * sizes ("galloping"). This is much faster than a binary search
+             * over the whole range when the element searched for is near
+             * the beginning, which is the case when looking up many keys
+             * in order.
+             *
+             * @param first Beginning of the range.
+             * @param last End of the range.
+             * @param key The key to search for.
+             * @param get_key Function returning the key for an element.
+             */
+            template <typename TIter, typename TKey, typename TGetKey>
+            TIter gallop_lower_bound(TIter first, TIter last, const TKey& key, TGetKey&& get_key) {
+                using diff_type = typename std::iterator_traits<TIter>::difference_type;
+
+                const diff_type size = std::distance(first, last);
+                diff_type low = 0;
+                diff_type step = 1;
+                while (step < size && get_key(*(first + step)) < key) {
+                    low = step;
+                    step *= 2;
+                }
+
+                const diff_type high = std::min(step + 1, size);
+                using element_type = typename std::iterator_traits<TIter>::value_type;
+                return std::lower_bound(first + low, first + high, key, [&get_key](const element_type& element, const TKey& k) {
+                    return get_key(element) < k;
+                });
+            }
+
+        } // namespace detail
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_SEARCH_HPP
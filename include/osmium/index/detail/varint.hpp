@@ -0,0 +1,106 @@
+#ifndef OSMIUM_INDEX_DETAIL_VARINT_HPP
+#define OSMIUM_INDEX_DETAIL_VARINT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cstdint>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Append value to the output in the variable-length encoding
+             * also used by Protobuf: 7 bits per byte, lowest bits first,
+             * the highest bit is set if more bytes follow.
+             */
+            inline void append_varint(std::vector<unsigned char>& out, uint64_t value) {
+                while (value >= 0x80U) {
+                    out.push_back(static_cast<unsigned char>((value & 0x7fU) | 0x80U));
+                    value >>= 7U;
+                }
+                out.push_back(static_cast<unsigned char>(value));
+            }
+
+            /**
+             * Decode a varint starting at data and advance data to the
+             * byte after it. Will not read beyond end, if the data is
+             * truncated the bits read so far are returned.
+             */
+            inline uint64_t decode_varint(const unsigned char*& data, const unsigned char* end) noexcept {
+                uint64_t value = 0;
+                unsigned int shift = 0;
+                while (data != end && shift < 64) {
+                    const unsigned char byte = *data++;
+                    value |= static_cast<uint64_t>(byte & 0x7fU) << shift;
+                    if ((byte & 0x80U) == 0) {
+                        break;
+                    }
+                    shift += 7;
+                }
+                return value;
+            }
+
+            /**
+             * Skip over a varint starting at data without decoding it.
+             */
+            inline void skip_varint(const unsigned char*& data, const unsigned char* end) noexcept {
+                while (data != end && (*data++ & 0x80U) != 0) {
+                }
+            }
+
+            /**
+             * Map signed integers to unsigned integers so that numbers
+             * with a small absolute value have a short varint encoding.
+             */
+            inline uint64_t zigzag_encode(const int64_t value) noexcept {
+                return (static_cast<uint64_t>(value) << 1U) ^ static_cast<uint64_t>(value >> 63);
+            }
+
+            /**
+             * Reverse of zigzag_encode().
+             */
+            inline int64_t zigzag_decode(const uint64_t value) noexcept {
+                return static_cast<int64_t>(value >> 1U) ^ -static_cast<int64_t>(value & 1U);
+            }
+
+        } // namespace detail
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_DETAIL_VARINT_HPP
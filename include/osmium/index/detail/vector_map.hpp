@@ -33,9 +33,11 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/search.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/map.hpp>
 #include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/prefetch.hpp>
 
 #include <algorithm>
 #include <cstddef>
@@ -52,6 +54,11 @@ namespace osmium {
             template <typename TVector, typename TId, typename TValue>
             class VectorBasedDenseMap : public Map<TId, TValue> {
 
+                // How many ids to look ahead in get_noexcept_bulk().
+                enum : std::size_t {
+                    prefetch_distance = 8
+                };
+
                 TVector m_vector;
 
             public:
@@ -106,6 +113,28 @@ namespace osmium {
                     return m_vector[id];
                 }
 
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    const std::size_t size = m_vector.size();
+                    const std::size_t ahead = std::min(count, static_cast<std::size_t>(prefetch_distance));
+                    for (std::size_t i = 0; i < ahead; ++i) {
+                        if (ids[i] < size) {
+                            osmium::prefetch(&m_vector[ids[i]]);
+                        }
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i + ahead < count && ids[i + ahead] < size) {
+                            osmium::prefetch(&m_vector[ids[i + ahead]]);
+                        }
+                        values[i] = ids[i] < size ? m_vector[ids[i]] : osmium::index::empty_value<TValue>();
+                    }
+                }
+
+                void prefetch(const TId id) const noexcept final {
+                    if (id < m_vector.size()) {
+                        osmium::prefetch(&m_vector[id]);
+                    }
+                }
+
                 std::size_t size() const final {
                     return m_vector.size();
                 }
@@ -199,6 +228,24 @@ namespace osmium {
                     m_vector.push_back(element_type(id, value));
                 }
 
+                /**
+                 * Add count elements at once. This does the same as calling
+                 * set() for each of them, but is much faster. To fill the
+                 * index from several threads, collect the elements in a
+                 * separate vector in each thread and hand those vectors to
+                 * this function (only one thread at a time!). Use
+                 * osmium::index::map::parallel_sort() from
+                 * osmium/index/map_parallel.hpp afterwards.
+                 */
+                void set_bulk(const element_type* elements, const std::size_t count) {
+                    if (count == 0) {
+                        return;
+                    }
+                    const std::size_t old_size = m_vector.size();
+                    m_vector.resize(old_size + count);
+                    std::copy_n(elements, count, &m_vector[old_size]);
+                }
+
                 TValue get(const TId id) const final {
                     const auto result = find_id(id);
                     if (result == m_vector.end() || result->first != id) {
@@ -217,6 +264,24 @@ namespace osmium {
                     return result->second;
                 }
 
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    auto it = m_vector.begin();
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i == 0 || ids[i] < ids[i - 1]) {
+                            it = find_id(ids[i]);
+                        } else {
+                            it = osmium::index::detail::gallop_lower_bound(it, m_vector.end(), ids[i], [](const element_type& element) {
+                                return element.first;
+                            });
+                        }
+                        if (it == m_vector.end() || it->first != ids[i]) {
+                            values[i] = osmium::index::empty_value<TValue>();
+                        } else {
+                            values[i] = it->second;
+                        }
+                    }
+                }
+
                 std::size_t size() const final {
                     return m_vector.size();
                 }
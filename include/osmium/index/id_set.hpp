@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/bit_packing.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/types.hpp>
 
@@ -40,10 +41,13 @@ DEALINGS IN THE SOFTWARE.
 #include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -111,6 +115,13 @@ namespace osmium {
         template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
         class IdSetDense;
 
+        namespace detail {
+
+            template <typename T, std::size_t chunk_bits>
+            struct id_set_dense_parallel;
+
+        } // namespace detail
+
         /**
          * Const_iterator for iterating over a IdSetDense.
          */
@@ -148,6 +159,7 @@ namespace osmium {
 
             using iterator_category = std::forward_iterator_tag;
             using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
             using pointer           = value_type*;
             using reference         = value_type&;
 
@@ -199,8 +211,10 @@ namespace osmium {
 
             static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
             static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+            static_assert(chunk_bits >= 3, "Chunk size must be a multiple of 8 bytes");
 
             friend class IdSetDenseIterator<T, chunk_bits>;
+            friend struct detail::id_set_dense_parallel<T, chunk_bits>;
 
             enum : std::size_t {
                 chunk_size = 1U << chunk_bits
@@ -240,6 +254,107 @@ namespace osmium {
                 return chunk[offset(id)];
             }
 
+            static T count_chunk(const unsigned char* chunk) noexcept {
+                T count = 0;
+                for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                    uint64_t word = 0;
+                    std::memcpy(&word, chunk + i, sizeof(uint64_t));
+                    count += detail::popcount(word);
+                }
+                return count;
+            }
+
+            // Combine the chunks word by word. These simple loops over
+            // whole chunks are vectorized by the compiler.
+            template <typename TOp>
+            static T combine_chunk(unsigned char* chunk, const unsigned char* other, TOp&& op) noexcept {
+                T count = 0;
+                for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                    uint64_t a = 0;
+                    uint64_t b = 0;
+                    std::memcpy(&a, chunk + i, sizeof(uint64_t));
+                    std::memcpy(&b, other + i, sizeof(uint64_t));
+                    a = op(a, b);
+                    std::memcpy(chunk + i, &a, sizeof(uint64_t));
+                    count += detail::popcount(a);
+                }
+                return count;
+            }
+
+            const unsigned char* other_chunk(const IdSetDense& other, std::size_t cid) const noexcept {
+                return cid < other.m_data.size() ? other.m_data[cid].get() : nullptr;
+            }
+
+            // The following functions work on a single chunk and return
+            // the number of Ids in the chunk after the operation. They
+            // are independent of each other for different chunks, so they
+            // can run in parallel.
+
+            T union_chunk(const IdSetDense& other, std::size_t cid) {
+                assert(cid < m_data.size());
+                auto& chunk = m_data[cid];
+                const unsigned char* src = other_chunk(other, cid);
+                if (!src) {
+                    return chunk ? count_chunk(chunk.get()) : 0;
+                }
+                if (!chunk) {
+                    chunk.reset(new unsigned char[chunk_size]);
+                    ::memcpy(chunk.get(), src, chunk_size);
+                    return count_chunk(chunk.get());
+                }
+                return combine_chunk(chunk.get(), src, [](uint64_t a, uint64_t b) {
+                    return a | b;
+                });
+            }
+
+            T intersect_chunk(const IdSetDense& other, std::size_t cid) {
+                assert(cid < m_data.size());
+                auto& chunk = m_data[cid];
+                if (!chunk) {
+                    return 0;
+                }
+                const unsigned char* src = other_chunk(other, cid);
+                if (!src) {
+                    chunk.reset();
+                    return 0;
+                }
+                return combine_chunk(chunk.get(), src, [](uint64_t a, uint64_t b) {
+                    return a & b;
+                });
+            }
+
+            T subtract_chunk(const IdSetDense& other, std::size_t cid) {
+                assert(cid < m_data.size());
+                auto& chunk = m_data[cid];
+                if (!chunk) {
+                    return 0;
+                }
+                const unsigned char* src = other_chunk(other, cid);
+                if (!src) {
+                    return count_chunk(chunk.get());
+                }
+                return combine_chunk(chunk.get(), src, [](uint64_t a, uint64_t b) {
+                    return a & ~b;
+                });
+            }
+
+            T intersection_size_chunk(const IdSetDense& other, std::size_t cid) const noexcept {
+                const unsigned char* chunk = m_data[cid].get();
+                const unsigned char* src = other_chunk(other, cid);
+                if (!chunk || !src) {
+                    return 0;
+                }
+                T count = 0;
+                for (std::size_t i = 0; i < chunk_size; i += sizeof(uint64_t)) {
+                    uint64_t a = 0;
+                    uint64_t b = 0;
+                    std::memcpy(&a, chunk + i, sizeof(uint64_t));
+                    std::memcpy(&b, src + i, sizeof(uint64_t));
+                    count += detail::popcount(a & b);
+                }
+                return count;
+            }
+
         public:
 
             using const_iterator = IdSetDenseIterator<T, chunk_bits>;
@@ -306,6 +421,33 @@ namespace osmium {
                 (void)check_and_set(id);
             }
 
+            /**
+             * Add all Ids in the range [first, last) to the set. This is
+             * much faster than calling set() for each Id if the Ids are
+             * sorted (or at least mostly in order), because it only has to
+             * look up the chunk when the Ids move into a new chunk.
+             *
+             * @param first Iterator to the first Id.
+             * @param last Iterator one past the last Id.
+             */
+            template <typename TIter>
+            void set(TIter first, TIter last) {
+                std::size_t current_cid = std::numeric_limits<std::size_t>::max();
+                unsigned char* chunk = nullptr;
+                for (; first != last; ++first) {
+                    const T id = *first;
+                    if (chunk_id(id) != current_cid) {
+                        chunk = &get_element(id) - offset(id);
+                        current_cid = chunk_id(id);
+                    }
+                    auto& element = chunk[offset(id)];
+                    if ((element & bitmask(id)) == 0) {
+                        element |= bitmask(id);
+                        ++m_size;
+                    }
+                }
+            }
+
             /**
              * Remove the given Id from the set.
              *
@@ -362,6 +504,54 @@ namespace osmium {
                 return m_data.size() * chunk_size;
             }
 
+            /**
+             * Add all Ids in the other set to this set.
+             */
+            void union_with(const IdSetDense& other) {
+                if (m_data.size() < other.m_data.size()) {
+                    m_data.resize(other.m_data.size());
+                }
+                T count = 0;
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    count += union_chunk(other, cid);
+                }
+                m_size = count;
+            }
+
+            /**
+             * Remove all Ids from this set that are not in the other set.
+             */
+            void intersect_with(const IdSetDense& other) {
+                T count = 0;
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    count += intersect_chunk(other, cid);
+                }
+                m_size = count;
+            }
+
+            /**
+             * Remove all Ids in the other set from this set.
+             */
+            void subtract(const IdSetDense& other) {
+                T count = 0;
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    count += subtract_chunk(other, cid);
+                }
+                m_size = count;
+            }
+
+            /**
+             * The number of Ids in both this and the other set. This does
+             * not change any of the sets.
+             */
+            T intersection_size(const IdSetDense& other) const noexcept {
+                T count = 0;
+                for (std::size_t cid = 0; cid < m_data.size(); ++cid) {
+                    count += intersection_size_chunk(other, cid);
+                }
+                return count;
+            }
+
             const_iterator begin() const {
                 return {this, 0, last()};
             }
@@ -0,0 +1,815 @@
+#ifndef OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
+#define OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/index/id_set.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            /**
+             * Container for the lower 16 bits of the Ids in an
+             * IdSetCompressed that share the same upper bits. Depending on
+             * the data, the Ids are stored in one of three ways:
+             *
+             * - array: sorted vector of values (for up to 4096 values)
+             * - bitmap: 65536 bits (for more than 4096 values)
+             * - run: sorted vector of (start, length - 1) pairs (only
+             *        created by optimize() if it uses less memory)
+             */
+            class id_set_container {
+
+            public:
+
+                enum class kind : uint8_t {
+                    array  = 0,
+                    bitmap = 1,
+                    run    = 2
+                };
+
+                enum : uint32_t {
+                    max_array_size = 4096,
+                    num_values     = 1U << 16U,
+                    bitmap_words   = num_values / 64
+                };
+
+            private:
+
+                // array values or run (start, length - 1) pairs
+                std::vector<uint16_t> m_values;
+
+                // bitmap words
+                std::vector<uint64_t> m_bits;
+
+                uint32_t m_cardinality = 0;
+
+                kind m_kind = kind::array;
+
+                static uint16_t to_low(uint32_t value) noexcept {
+                    return static_cast<uint16_t>(value);
+                }
+
+                void set_bit(uint32_t value) noexcept {
+                    m_bits[value >> 6U] |= 1ULL << (value & 63U);
+                }
+
+                void count_bits() noexcept {
+                    m_cardinality = 0;
+                    for (const auto word : m_bits) {
+                        m_cardinality += popcount(word);
+                    }
+                }
+
+                std::size_t num_runs() const noexcept {
+                    if (m_kind == kind::run) {
+                        return m_values.size() / 2;
+                    }
+                    std::size_t runs = 0;
+                    uint32_t last = num_values + 1;
+                    for_each([&runs, &last](uint32_t value) {
+                        if (value != last + 1) {
+                            ++runs;
+                        }
+                        last = value;
+                    });
+                    return runs;
+                }
+
+                void make_array() {
+                    std::vector<uint16_t> values;
+                    values.reserve(m_cardinality);
+                    for_each([&values](uint32_t value) {
+                        values.push_back(to_low(value));
+                    });
+                    m_values.swap(values);
+                    m_bits.clear();
+                    m_bits.shrink_to_fit();
+                    m_kind = kind::array;
+                }
+
+                void make_bitmap() {
+                    std::vector<uint64_t> bits(bitmap_words, 0);
+                    m_bits.swap(bits);
+                    for_each([this](uint32_t value) {
+                        set_bit(value);
+                    });
+                    m_values.clear();
+                    m_values.shrink_to_fit();
+                    m_kind = kind::bitmap;
+                }
+
+                void make_runs() {
+                    std::vector<uint16_t> runs;
+                    uint32_t start = 0;
+                    uint32_t last = num_values + 1;
+                    for_each([&](uint32_t value) {
+                        if (value != last + 1) {
+                            if (last != num_values + 1) {
+                                runs.push_back(to_low(start));
+                                runs.push_back(to_low(last - start));
+                            }
+                            start = value;
+                        }
+                        last = value;
+                    });
+                    if (last != num_values + 1) {
+                        runs.push_back(to_low(start));
+                        runs.push_back(to_low(last - start));
+                    }
+                    m_values.swap(runs);
+                    m_bits.clear();
+                    m_bits.shrink_to_fit();
+                    m_kind = kind::run;
+                }
+
+                // Convert run container into array or bitmap container
+                // and bitmap into array container if it is small enough.
+                void normalize() {
+                    if (m_cardinality > max_array_size) {
+                        if (m_kind != kind::bitmap) {
+                            make_bitmap();
+                        }
+                    } else if (m_kind != kind::array) {
+                        make_array();
+                    }
+                }
+
+            public:
+
+                kind get_kind() const noexcept {
+                    return m_kind;
+                }
+
+                uint32_t cardinality() const noexcept {
+                    return m_cardinality;
+                }
+
+                bool empty() const noexcept {
+                    return m_cardinality == 0;
+                }
+
+                const std::vector<uint16_t>& values() const noexcept {
+                    return m_values;
+                }
+
+                const std::vector<uint64_t>& bits() const noexcept {
+                    return m_bits;
+                }
+
+                std::size_t used_memory() const noexcept {
+                    return sizeof(id_set_container) +
+                           m_values.capacity() * sizeof(uint16_t) +
+                           m_bits.capacity() * sizeof(uint64_t);
+                }
+
+                /**
+                 * Get first value >= the given value in a bitmap container.
+                 * Returns num_values if there is none.
+                 */
+                uint32_t next_bit(uint32_t value) const noexcept {
+                    assert(m_kind == kind::bitmap);
+                    uint32_t word = value >> 6U;
+                    if (word >= bitmap_words) {
+                        return num_values;
+                    }
+                    uint64_t bits = m_bits[word] & (~0ULL << (value & 63U));
+                    while (bits == 0) {
+                        if (++word == bitmap_words) {
+                            return num_values;
+                        }
+                        bits = m_bits[word];
+                    }
+                    return word * 64 + count_trailing_zeros(bits);
+                }
+
+                /**
+                 * Call func(value) for all values in the container in
+                 * order.
+                 */
+                template <typename TFunc>
+                void for_each(TFunc&& func) const {
+                    switch (m_kind) {
+                        case kind::array:
+                            for (const auto value : m_values) {
+                                func(static_cast<uint32_t>(value));
+                            }
+                            break;
+                        case kind::bitmap:
+                            for (uint32_t word = 0; word < bitmap_words; ++word) {
+                                uint64_t bits = m_bits[word];
+                                while (bits != 0) {
+                                    func(word * 64 + count_trailing_zeros(bits));
+                                    bits &= bits - 1;
+                                }
+                            }
+                            break;
+                        case kind::run:
+                            for (std::size_t i = 0; i < m_values.size(); i += 2) {
+                                const uint32_t start = m_values[i];
+                                const uint32_t end = start + m_values[i + 1];
+                                for (uint32_t value = start; value <= end; ++value) {
+                                    func(value);
+                                }
+                            }
+                            break;
+                    }
+                }
+
+                bool get(const uint16_t value) const noexcept {
+                    switch (m_kind) {
+                        case kind::array:
+                            return std::binary_search(m_values.cbegin(), m_values.cend(), value);
+                        case kind::bitmap:
+                            return (m_bits[value >> 6U] & (1ULL << (value & 63U))) != 0;
+                        case kind::run:
+                            break;
+                    }
+
+                    // find first run starting after value, the run before
+                    // that might contain the value
+                    std::size_t low = 0;
+                    std::size_t high = m_values.size() / 2;
+                    while (low < high) {
+                        const std::size_t mid = (low + high) / 2;
+                        if (m_values[mid * 2] <= value) {
+                            low = mid + 1;
+                        } else {
+                            high = mid;
+                        }
+                    }
+                    if (low == 0) {
+                        return false;
+                    }
+                    const uint32_t start = m_values[(low - 1) * 2];
+                    return value <= start + m_values[(low - 1) * 2 + 1];
+                }
+
+                /**
+                 * Add value to container.
+                 *
+                 * @returns true if the value was added, false if it was
+                 *          already in the container.
+                 */
+                bool set(const uint16_t value) {
+                    if (m_kind == kind::run) {
+                        if (get(value)) {
+                            return false;
+                        }
+                        normalize();
+                    }
+
+                    if (m_kind == kind::bitmap) {
+                        auto& word = m_bits[value >> 6U];
+                        const uint64_t mask = 1ULL << (value & 63U);
+                        if ((word & mask) != 0) {
+                            return false;
+                        }
+                        word |= mask;
+                        ++m_cardinality;
+                        return true;
+                    }
+
+                    if (m_values.empty() || m_values.back() < value) {
+                        m_values.push_back(value);
+                    } else {
+                        const auto it = std::lower_bound(m_values.begin(), m_values.end(), value);
+                        if (*it == value) {
+                            return false;
+                        }
+                        m_values.insert(it, value);
+                    }
+                    ++m_cardinality;
+                    if (m_cardinality > max_array_size) {
+                        make_bitmap();
+                    }
+                    return true;
+                }
+
+                /**
+                 * Remove value from container.
+                 *
+                 * @returns true if the value was removed, false if it was
+                 *          not in the container.
+                 */
+                bool unset(const uint16_t value) {
+                    if (!get(value)) {
+                        return false;
+                    }
+                    if (m_kind == kind::run) {
+                        if (m_cardinality > max_array_size) {
+                            make_bitmap();
+                        } else {
+                            make_array();
+                        }
+                    }
+                    if (m_kind == kind::bitmap) {
+                        m_bits[value >> 6U] &= ~(1ULL << (value & 63U));
+                        --m_cardinality;
+                        normalize();
+                    } else {
+                        m_values.erase(std::lower_bound(m_values.begin(), m_values.end(), value));
+                        --m_cardinality;
+                    }
+                    return true;
+                }
+
+                /**
+                 * Choose the representation needing the least amount of
+                 * memory.
+                 */
+                void optimize() {
+                    const std::size_t array_bytes = m_cardinality * sizeof(uint16_t);
+                    const std::size_t bitmap_bytes = bitmap_words * sizeof(uint64_t);
+                    const std::size_t run_bytes = num_runs() * 2 * sizeof(uint16_t);
+
+                    if (run_bytes < array_bytes && run_bytes < bitmap_bytes) {
+                        if (m_kind != kind::run) {
+                            make_runs();
+                        }
+                    } else {
+                        normalize();
+                    }
+                    m_values.shrink_to_fit();
+                }
+
+                /// Add all values from the other container to this one.
+                void union_with(const id_set_container& other) {
+                    normalize();
+                    if (m_kind == kind::array && other.m_kind == kind::array) {
+                        std::vector<uint16_t> values;
+                        values.reserve(m_values.size() + other.m_values.size());
+                        std::set_union(m_values.cbegin(), m_values.cend(),
+                                       other.m_values.cbegin(), other.m_values.cend(),
+                                       std::back_inserter(values));
+                        m_values.swap(values);
+                        m_cardinality = static_cast<uint32_t>(m_values.size());
+                        if (m_cardinality > max_array_size) {
+                            make_bitmap();
+                        }
+                        return;
+                    }
+
+                    if (m_kind != kind::bitmap) {
+                        make_bitmap();
+                    }
+                    if (other.m_kind == kind::bitmap) {
+                        for (uint32_t word = 0; word < bitmap_words; ++word) {
+                            m_bits[word] |= other.m_bits[word];
+                        }
+                    } else {
+                        other.for_each([this](uint32_t value) {
+                            set_bit(value);
+                        });
+                    }
+                    count_bits();
+                    normalize();
+                }
+
+                /// Remove all values from this container not in the other.
+                void intersect_with(const id_set_container& other) {
+                    normalize();
+                    if (m_kind == kind::bitmap && other.m_kind == kind::bitmap) {
+                        for (uint32_t word = 0; word < bitmap_words; ++word) {
+                            m_bits[word] &= other.m_bits[word];
+                        }
+                        count_bits();
+                        normalize();
+                        return;
+                    }
+
+                    // Look up the values of the container with fewer
+                    // values in the other one. The result is built as an
+                    // array and converted into a bitmap if it is too large
+                    // (this can happen if the other container is a run
+                    // container).
+                    const bool this_is_smaller = m_cardinality <= other.m_cardinality;
+                    const id_set_container& smaller = this_is_smaller ? *this : other;
+                    const id_set_container& larger = this_is_smaller ? other : *this;
+                    std::vector<uint16_t> values;
+                    smaller.for_each([&](uint32_t value) {
+                        if (larger.get(to_low(value))) {
+                            values.push_back(to_low(value));
+                        }
+                    });
+                    m_values.swap(values);
+                    m_bits.clear();
+                    m_bits.shrink_to_fit();
+                    m_kind = kind::array;
+                    m_cardinality = static_cast<uint32_t>(m_values.size());
+                    normalize();
+                }
+
+            }; // class id_set_container
+
+        } // namespace detail
+
+        template <typename T>
+        class IdSetCompressed;
+
+        /**
+         * Const_iterator for iterating over a IdSetCompressed.
+         */
+        template <typename T>
+        class IdSetCompressedIterator {
+
+            using id_set = IdSetCompressed<T>;
+            using container = detail::id_set_container;
+
+            const id_set* m_set;
+            std::size_t m_container;
+            uint32_t m_low = 0;
+            std::size_t m_pos = 0;
+
+            const container& current() const noexcept {
+                return m_set->m_containers[m_container];
+            }
+
+            void first_in_container() noexcept {
+                if (m_container == m_set->m_containers.size()) {
+                    return;
+                }
+                m_pos = 0;
+                if (current().get_kind() == container::kind::bitmap) {
+                    m_low = current().next_bit(0);
+                } else {
+                    m_low = current().values()[0];
+                }
+            }
+
+            void next_container() noexcept {
+                ++m_container;
+                first_in_container();
+            }
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = value_type*;
+            using reference         = value_type&;
+
+            IdSetCompressedIterator(const id_set* set, std::size_t container_num) noexcept :
+                m_set(set),
+                m_container(container_num) {
+                first_in_container();
+            }
+
+            IdSetCompressedIterator& operator++() noexcept {
+                assert(m_container < m_set->m_containers.size());
+                const auto& c = current();
+                switch (c.get_kind()) {
+                    case container::kind::array:
+                        if (++m_pos < c.values().size()) {
+                            m_low = c.values()[m_pos];
+                        } else {
+                            next_container();
+                        }
+                        break;
+                    case container::kind::bitmap:
+                        m_low = c.next_bit(m_low + 1);
+                        if (m_low == container::num_values) {
+                            next_container();
+                        }
+                        break;
+                    case container::kind::run:
+                        if (m_low < static_cast<uint32_t>(c.values()[m_pos]) + c.values()[m_pos + 1]) {
+                            ++m_low;
+                        } else if ((m_pos += 2) < c.values().size()) {
+                            m_low = c.values()[m_pos];
+                        } else {
+                            next_container();
+                        }
+                        break;
+                }
+                return *this;
+            }
+
+            IdSetCompressedIterator operator++(int) noexcept {
+                IdSetCompressedIterator tmp{*this};
+                operator++();
+                return tmp;
+            }
+
+            bool operator==(const IdSetCompressedIterator& rhs) const noexcept {
+                return m_set == rhs.m_set && m_container == rhs.m_container &&
+                       (m_container == m_set->m_containers.size() || m_low == rhs.m_low);
+            }
+
+            bool operator!=(const IdSetCompressedIterator& rhs) const noexcept {
+                return !(*this == rhs);
+            }
+
+            T operator*() const noexcept {
+                assert(m_container < m_set->m_containers.size());
+                return (m_set->m_keys[m_container] << 16U) | static_cast<T>(m_low);
+            }
+
+        }; // class IdSetCompressedIterator
+
+        /**
+         * A compressed set of Ids of the given type. The Ids are split up
+         * into groups of 65536 Ids with the same upper bits. The lower
+         * 16 bits of each group are stored in a container that adapts to
+         * the data: Small groups are stored as sorted arrays, large groups
+         * as bitmaps and, after calling optimize(), groups with long runs
+         * of consecutive Ids as run-length encoded lists. (This is the
+         * same idea as in "Roaring bitmaps".)
+         *
+         * This needs much less memory than an IdSetDense for sparse Ids
+         * spread over a large Id range and lookups are much faster than
+         * in an IdSetSmall.
+         */
+        template <typename T>
+        class IdSetCompressed : public IdSet<T> {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+            static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+
+            friend class IdSetCompressedIterator<T>;
+
+            using container = detail::id_set_container;
+
+            // sorted upper bits of the Ids in each container
+            std::vector<T> m_keys;
+            std::vector<container> m_containers;
+            T m_size = 0;
+
+            static T key(T id) noexcept {
+                return id >> 16U;
+            }
+
+            static uint16_t low(T id) noexcept {
+                return static_cast<uint16_t>(id & 0xffffU);
+            }
+
+            std::size_t find_container(T k) const noexcept {
+                const auto it = std::lower_bound(m_keys.cbegin(), m_keys.cend(), k);
+                if (it == m_keys.cend() || *it != k) {
+                    return m_keys.size();
+                }
+                return static_cast<std::size_t>(std::distance(m_keys.cbegin(), it));
+            }
+
+            container& get_container(T k) {
+                if (m_keys.empty() || m_keys.back() < k) {
+                    m_keys.push_back(k);
+                    m_containers.emplace_back();
+                    return m_containers.back();
+                }
+                if (m_keys.back() == k) {
+                    return m_containers.back();
+                }
+                const auto it = std::lower_bound(m_keys.begin(), m_keys.end(), k);
+                const auto pos = std::distance(m_keys.begin(), it);
+                if (*it != k) {
+                    m_keys.insert(it, k);
+                    m_containers.emplace(m_containers.begin() + pos);
+                }
+                return m_containers[static_cast<std::size_t>(pos)];
+            }
+
+            void count() noexcept {
+                m_size = 0;
+                for (const auto& c : m_containers) {
+                    m_size += c.cardinality();
+                }
+            }
+
+        public:
+
+            using const_iterator = IdSetCompressedIterator<T>;
+
+            IdSetCompressed() = default;
+
+            /**
+             * Add the Id to the set if it is not already in there.
+             *
+             * @param id The Id to set.
+             * @returns true if the Id was added, false if it was already set.
+             */
+            bool check_and_set(T id) {
+                if (get_container(key(id)).set(low(id))) {
+                    ++m_size;
+                    return true;
+                }
+                return false;
+            }
+
+            /**
+             * Add the given Id to the set.
+             *
+             * @param id The Id to set.
+             */
+            void set(T id) final {
+                (void)check_and_set(id);
+            }
+
+            /**
+             * Remove the given Id from the set.
+             *
+             * @param id The Id to remove.
+             */
+            void unset(T id) {
+                const auto pos = find_container(key(id));
+                if (pos == m_keys.size()) {
+                    return;
+                }
+                if (m_containers[pos].unset(low(id))) {
+                    --m_size;
+                    if (m_containers[pos].empty()) {
+                        m_keys.erase(m_keys.begin() + static_cast<std::ptrdiff_t>(pos));
+                        m_containers.erase(m_containers.begin() + static_cast<std::ptrdiff_t>(pos));
+                    }
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             *
+             * @param id The Id to check.
+             */
+            bool get(T id) const noexcept final {
+                const auto pos = find_container(key(id));
+                if (pos == m_keys.size()) {
+                    return false;
+                }
+                return m_containers[pos].get(low(id));
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept final {
+                return m_size == 0;
+            }
+
+            /**
+             * The number of Ids stored in the set.
+             */
+            T size() const noexcept {
+                return m_size;
+            }
+
+            /**
+             * Clear the set.
+             */
+            void clear() final {
+                m_keys.clear();
+                m_containers.clear();
+                m_size = 0;
+            }
+
+            std::size_t used_memory() const noexcept final {
+                std::size_t memory = m_keys.capacity() * sizeof(T);
+                for (const auto& c : m_containers) {
+                    memory += c.used_memory();
+                }
+                return memory + (m_containers.capacity() - m_containers.size()) * sizeof(container);
+            }
+
+            /**
+             * Convert all containers into the representation needing the
+             * least amount of memory. Call this after all Ids have been
+             * added. This can create run-length encoded containers which
+             * are slower to update, so it should only be called when the
+             * set will not be changed much any more.
+             */
+            void optimize() {
+                for (auto& c : m_containers) {
+                    c.optimize();
+                }
+                m_keys.shrink_to_fit();
+                m_containers.shrink_to_fit();
+            }
+
+            /**
+             * Add all Ids from the other set to this set.
+             */
+            void union_with(const IdSetCompressed<T>& other) {
+                if (&other == this) {
+                    return;
+                }
+                std::vector<T> keys;
+                std::vector<container> containers;
+                keys.reserve(m_keys.size() + other.m_keys.size());
+                containers.reserve(m_keys.size() + other.m_keys.size());
+
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while (i < m_keys.size() || j < other.m_keys.size()) {
+                    if (j == other.m_keys.size() || (i < m_keys.size() && m_keys[i] < other.m_keys[j])) {
+                        keys.push_back(m_keys[i]);
+                        containers.push_back(std::move(m_containers[i]));
+                        ++i;
+                    } else if (i == m_keys.size() || other.m_keys[j] < m_keys[i]) {
+                        keys.push_back(other.m_keys[j]);
+                        containers.push_back(other.m_containers[j]);
+                        ++j;
+                    } else {
+                        keys.push_back(m_keys[i]);
+                        containers.push_back(std::move(m_containers[i]));
+                        containers.back().union_with(other.m_containers[j]);
+                        ++i;
+                        ++j;
+                    }
+                }
+
+                m_keys.swap(keys);
+                m_containers.swap(containers);
+                count();
+            }
+
+            /**
+             * Remove all Ids from this set which are not in the other set.
+             */
+            void intersect_with(const IdSetCompressed<T>& other) {
+                if (&other == this) {
+                    return;
+                }
+                std::size_t out = 0;
+                std::size_t j = 0;
+                for (std::size_t i = 0; i < m_keys.size(); ++i) {
+                    while (j < other.m_keys.size() && other.m_keys[j] < m_keys[i]) {
+                        ++j;
+                    }
+                    if (j == other.m_keys.size()) {
+                        break;
+                    }
+                    if (other.m_keys[j] != m_keys[i]) {
+                        continue;
+                    }
+                    m_containers[i].intersect_with(other.m_containers[j]);
+                    if (!m_containers[i].empty()) {
+                        if (out != i) {
+                            m_keys[out] = m_keys[i];
+                            m_containers[out] = std::move(m_containers[i]);
+                        }
+                        ++out;
+                    }
+                }
+
+                m_keys.resize(out);
+                m_containers.erase(m_containers.begin() + static_cast<std::ptrdiff_t>(out), m_containers.end());
+                count();
+            }
+
+            const_iterator begin() const {
+                return {this, 0};
+            }
+
+            const_iterator end() const {
+                return {this, m_containers.size()};
+            }
+
+        }; // class IdSetCompressed
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_ID_SET_COMPRESSED_HPP
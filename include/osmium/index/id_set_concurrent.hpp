@@ -0,0 +1,306 @@
+#ifndef OSMIUM_INDEX_ID_SET_CONCURRENT_HPP
+#define OSMIUM_INDEX_ID_SET_CONCURRENT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/index/id_set.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace osmium {
+
+    namespace index {
+
+        /**
+         * A set of Ids of the given type that can be changed from several
+         * threads at the same time without any locking. This is useful,
+         * for instance, to mark all nodes needed by some ways while the
+         * ways are processed in parallel.
+         *
+         * Like the IdSetDense the Ids are stored in bit fields in chunks
+         * allocated on demand. Bits are set using atomic OR operations
+         * and new chunks are installed with an atomic compare-and-swap,
+         * so set(), check_and_set(), unset() and get() can be called
+         * concurrently. The table of chunks can not grow while the set is
+         * in use, so the largest possible Id has to be given in the
+         * constructor.
+         *
+         * size() and empty() have to look at all chunks. They (and the
+         * other functions) can be called concurrently, but their result
+         * might be outdated if other threads change the set at the same
+         * time. clear() must not be called concurrently with anything
+         * else.
+         */
+        template <typename T, std::size_t chunk_bits = detail::default_chunk_bits>
+        class ConcurrentIdSetDense : public IdSet<T> {
+
+            static_assert(std::is_unsigned<T>::value, "Needs unsigned type");
+            static_assert(sizeof(T) >= 4, "Needs at least 32bit type");
+            static_assert(chunk_bits >= 3, "Chunk size must be a multiple of 8 bytes");
+
+            using word_type = std::atomic<uint64_t>;
+
+            enum : std::size_t {
+                // number of 64 bit words in a chunk
+                chunk_words = (std::size_t(1) << chunk_bits) / sizeof(uint64_t),
+
+                // number of Ids in a chunk
+                chunk_ids = std::size_t(1) << (chunk_bits + 3U)
+            };
+
+            std::unique_ptr<std::atomic<word_type*>[]> m_chunks;
+            std::size_t m_num_chunks;
+
+            static std::size_t chunk_id(T id) noexcept {
+                return static_cast<std::size_t>(id >> (chunk_bits + 3U));
+            }
+
+            static std::size_t word_offset(T id) noexcept {
+                return static_cast<std::size_t>(id >> 6U) & (chunk_words - 1);
+            }
+
+            static uint64_t bitmask(T id) noexcept {
+                return 1ULL << (id & 0x3fU);
+            }
+
+            word_type* chunk(T id) const noexcept {
+                const auto cid = chunk_id(id);
+                if (cid >= m_num_chunks) {
+                    return nullptr;
+                }
+                return m_chunks[cid].load(std::memory_order_acquire);
+            }
+
+            word_type& get_word(T id) {
+                const auto cid = chunk_id(id);
+                if (cid >= m_num_chunks) {
+                    throw std::out_of_range{"Id " + std::to_string(id) + " too large for ConcurrentIdSetDense"};
+                }
+
+                word_type* data = m_chunks[cid].load(std::memory_order_acquire);
+                if (!data) {
+                    std::unique_ptr<word_type[]> new_data{new word_type[chunk_words]};
+                    for (std::size_t i = 0; i < chunk_words; ++i) {
+                        new_data[i].store(0, std::memory_order_relaxed);
+                    }
+                    // If another thread was faster, use its chunk and
+                    // throw ours away.
+                    if (m_chunks[cid].compare_exchange_strong(data, new_data.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        data = new_data.release();
+                    }
+                }
+
+                return data[word_offset(id)];
+            }
+
+            void free_chunks() noexcept {
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    delete[] m_chunks[cid].exchange(nullptr);
+                }
+            }
+
+        public:
+
+            /**
+             * Create set.
+             *
+             * @param max_id The largest Id that can be stored in the set.
+             *               The default allows Ids up to 2^36 which is
+             *               enough for all OSM object Ids for years to
+             *               come. This needs 8 bytes for each chunk
+             *               of 2^(chunk_bits+3) Ids.
+             */
+            explicit ConcurrentIdSetDense(T max_id = static_cast<T>((1ULL << 36U) - 1)) :
+                m_chunks(new std::atomic<word_type*>[chunk_id(max_id) + 1]),
+                m_num_chunks(chunk_id(max_id) + 1) {
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    m_chunks[cid].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            ConcurrentIdSetDense(const ConcurrentIdSetDense&) = delete;
+            ConcurrentIdSetDense& operator=(const ConcurrentIdSetDense&) = delete;
+
+            ConcurrentIdSetDense(ConcurrentIdSetDense&&) = delete;
+            ConcurrentIdSetDense& operator=(ConcurrentIdSetDense&&) = delete;
+
+            ~ConcurrentIdSetDense() noexcept override {
+                free_chunks();
+            }
+
+            /**
+             * Add the Id to the set if it is not already in there. If
+             * several threads call this with the same Id at the same
+             * time, exactly one of them will get true as result.
+             *
+             * @param id The Id to set.
+             * @returns true if the Id was added, false if it was already set.
+             * @throws std::out_of_range if the Id is larger than the
+             *         maximum Id given in the constructor.
+             */
+            bool check_and_set(T id) {
+                const uint64_t mask = bitmask(id);
+                return (get_word(id).fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+            }
+
+            /**
+             * Add the given Id to the set.
+             *
+             * @param id The Id to set.
+             * @throws std::out_of_range if the Id is larger than the
+             *         maximum Id given in the constructor.
+             */
+            void set(T id) final {
+                auto& word = get_word(id);
+                const uint64_t mask = bitmask(id);
+                // avoid the more expensive atomic write if the bit is
+                // already set
+                if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+                    word.fetch_or(mask, std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Remove the given Id from the set.
+             *
+             * @param id The Id to remove.
+             */
+            void unset(T id) noexcept {
+                word_type* data = chunk(id);
+                if (data) {
+                    data[word_offset(id)].fetch_and(~bitmask(id), std::memory_order_relaxed);
+                }
+            }
+
+            /**
+             * Is the Id in the set?
+             *
+             * @param id The Id to check.
+             */
+            bool get(T id) const noexcept final {
+                const word_type* data = chunk(id);
+                if (!data) {
+                    return false;
+                }
+                return (data[word_offset(id)].load(std::memory_order_relaxed) & bitmask(id)) != 0;
+            }
+
+            /**
+             * Is the set empty?
+             */
+            bool empty() const noexcept final {
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    const word_type* data = m_chunks[cid].load(std::memory_order_acquire);
+                    if (data) {
+                        for (std::size_t i = 0; i < chunk_words; ++i) {
+                            if (data[i].load(std::memory_order_relaxed) != 0) {
+                                return false;
+                            }
+                        }
+                    }
+                }
+                return true;
+            }
+
+            /**
+             * The number of Ids stored in the set. This has to count the
+             * bits in all chunks.
+             */
+            T size() const noexcept {
+                T count = 0;
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    const word_type* data = m_chunks[cid].load(std::memory_order_acquire);
+                    if (data) {
+                        for (std::size_t i = 0; i < chunk_words; ++i) {
+                            count += detail::popcount(data[i].load(std::memory_order_relaxed));
+                        }
+                    }
+                }
+                return count;
+            }
+
+            /**
+             * Clear the set. Must not be called while other threads
+             * access the set.
+             */
+            void clear() final {
+                free_chunks();
+            }
+
+            std::size_t used_memory() const noexcept final {
+                std::size_t memory = m_num_chunks * sizeof(std::atomic<word_type*>);
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    if (m_chunks[cid].load(std::memory_order_relaxed)) {
+                        memory += chunk_words * sizeof(word_type);
+                    }
+                }
+                return memory;
+            }
+
+            /**
+             * Call func(id) for all Ids in the set in order. If other
+             * threads change the set at the same time, it is undefined
+             * whether those changes are seen.
+             */
+            template <typename TFunc>
+            void for_each(TFunc&& func) const {
+                for (std::size_t cid = 0; cid < m_num_chunks; ++cid) {
+                    const word_type* data = m_chunks[cid].load(std::memory_order_acquire);
+                    if (!data) {
+                        continue;
+                    }
+                    for (std::size_t i = 0; i < chunk_words; ++i) {
+                        uint64_t bits = data[i].load(std::memory_order_relaxed);
+                        while (bits != 0) {
+                            const T id = static_cast<T>(cid * chunk_ids + i * 64 + detail::count_trailing_zeros(bits));
+                            func(id);
+                            bits &= bits - 1;
+                        }
+                    }
+                }
+            }
+
+        }; // class ConcurrentIdSetDense
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_ID_SET_CONCURRENT_HPP
@@ -0,0 +1,148 @@
+#ifndef OSMIUM_INDEX_ID_SET_PARALLEL_HPP
+#define OSMIUM_INDEX_ID_SET_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/id_set.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            template <typename T, std::size_t chunk_bits>
+            struct id_set_dense_parallel {
+
+                using set_type = IdSetDense<T, chunk_bits>;
+
+                // Run func(cid) for all chunks using the pool and return
+                // the sum of the results.
+                template <typename TFunc>
+                static T run(osmium::thread::Pool& pool, const std::size_t num_chunks, TFunc&& func) {
+                    std::vector<T> counts(num_chunks, 0);
+                    osmium::thread::run_in_parallel(pool, num_chunks, [&counts, &func](std::size_t cid) {
+                        counts[cid] = func(cid);
+                    });
+                    return std::accumulate(counts.cbegin(), counts.cend(), T{0});
+                }
+
+                static void union_with(set_type& set, const set_type& other, osmium::thread::Pool& pool) {
+                    if (set.m_data.size() < other.m_data.size()) {
+                        set.m_data.resize(other.m_data.size());
+                    }
+                    set.m_size = run(pool, set.m_data.size(), [&set, &other](std::size_t cid) {
+                        return set.union_chunk(other, cid);
+                    });
+                }
+
+                static void intersect_with(set_type& set, const set_type& other, osmium::thread::Pool& pool) {
+                    set.m_size = run(pool, set.m_data.size(), [&set, &other](std::size_t cid) {
+                        return set.intersect_chunk(other, cid);
+                    });
+                }
+
+                static void subtract(set_type& set, const set_type& other, osmium::thread::Pool& pool) {
+                    set.m_size = run(pool, set.m_data.size(), [&set, &other](std::size_t cid) {
+                        return set.subtract_chunk(other, cid);
+                    });
+                }
+
+                static T intersection_size(const set_type& set, const set_type& other, osmium::thread::Pool& pool) {
+                    return run(pool, set.m_data.size(), [&set, &other](std::size_t cid) {
+                        return set.intersection_size_chunk(other, cid);
+                    });
+                }
+
+            }; // struct id_set_dense_parallel
+
+        } // namespace detail
+
+        /**
+         * Add all Ids in the other set to the set. Does the same as
+         * IdSetDense::union_with(), but the chunks are processed in
+         * parallel using the threads in the pool.
+         *
+         * Do not call this from a task running in the same pool.
+         */
+        template <typename T, std::size_t chunk_bits>
+        void parallel_union_with(IdSetDense<T, chunk_bits>& set, const IdSetDense<T, chunk_bits>& other, osmium::thread::Pool& pool) {
+            detail::id_set_dense_parallel<T, chunk_bits>::union_with(set, other, pool);
+        }
+
+        /**
+         * Remove all Ids from the set that are not in the other set. Does
+         * the same as IdSetDense::intersect_with(), but the chunks are
+         * processed in parallel using the threads in the pool.
+         *
+         * Do not call this from a task running in the same pool.
+         */
+        template <typename T, std::size_t chunk_bits>
+        void parallel_intersect_with(IdSetDense<T, chunk_bits>& set, const IdSetDense<T, chunk_bits>& other, osmium::thread::Pool& pool) {
+            detail::id_set_dense_parallel<T, chunk_bits>::intersect_with(set, other, pool);
+        }
+
+        /**
+         * Remove all Ids in the other set from the set. Does the same as
+         * IdSetDense::subtract(), but the chunks are processed in
+         * parallel using the threads in the pool.
+         *
+         * Do not call this from a task running in the same pool.
+         */
+        template <typename T, std::size_t chunk_bits>
+        void parallel_subtract(IdSetDense<T, chunk_bits>& set, const IdSetDense<T, chunk_bits>& other, osmium::thread::Pool& pool) {
+            detail::id_set_dense_parallel<T, chunk_bits>::subtract(set, other, pool);
+        }
+
+        /**
+         * The number of Ids in both sets. Does the same as
+         * IdSetDense::intersection_size(), but the chunks are processed
+         * in parallel using the threads in the pool.
+         *
+         * Do not call this from a task running in the same pool.
+         */
+        template <typename T, std::size_t chunk_bits>
+        T parallel_intersection_size(const IdSetDense<T, chunk_bits>& set, const IdSetDense<T, chunk_bits>& other, osmium::thread::Pool& pool) {
+            return detail::id_set_dense_parallel<T, chunk_bits>::intersection_size(set, other, pool);
+        }
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_ID_SET_PARALLEL_HPP
@@ -44,6 +44,7 @@ DEALINGS IN THE SOFTWARE.
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -146,6 +147,41 @@ namespace osmium {
                  */
                 virtual TValue get_noexcept(const TId id) const noexcept = 0;
 
+                /**
+                 * Retrieve values for many ids at once. This does the same
+                 * as calling get_noexcept() for each id, but some
+                 * implementations can do this much faster. Sparse maps
+                 * are faster if the ids are sorted, because they don't have
+                 * to search the whole map for each id. Dense maps prefetch
+                 * the memory for later ids while working on the current one.
+                 *
+                 * @param ids Pointer to the first of count ids to look for.
+                 * @param count Number of ids.
+                 * @param values Pointer to an array of at least count
+                 *               elements where the values will be written
+                 *               to. If an id is not found, the empty value
+                 *               is written.
+                 */
+                virtual void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        values[i] = get_noexcept(ids[i]);
+                    }
+                }
+
+                /**
+                 * Hint that the value for the given id will be needed soon.
+                 * Implementations can use this to prefetch the memory where
+                 * the value is stored, so that a later call to get() or
+                 * get_noexcept() does not have to wait for it. This is
+                 * useful for indexes with random memory access patterns,
+                 * such as the dense indexes.
+                 *
+                 * @param id The id that will be looked up.
+                 */
+                virtual void prefetch(const TId /*id*/) const noexcept {
+                    // default implementation is empty
+                }
+
                 /**
                  * Get the approximate number of items in the storage. The storage
                  * might allocate memory in blocks, so this size might not be
@@ -204,10 +240,12 @@ namespace osmium {
             using value_type      = TValue;
             using map_type        = osmium::index::map::Map<id_type, value_type>;
             using create_map_func = std::function<map_type*(const std::vector<std::string>&)>;
+            using estimate_memory_func = std::function<std::size_t(std::size_t, id_type)>;
 
         private:
 
             std::map<const std::string, create_map_func> m_callbacks;
+            std::map<const std::string, estimate_memory_func> m_estimates;
 
             MapFactory() = default;
 
@@ -230,6 +268,14 @@ namespace osmium {
                 return m_callbacks.emplace(map_type_name, func).second;
             }
 
+            bool register_map(const std::string& map_type_name, create_map_func func, estimate_memory_func estimate) {
+                if (!register_map(map_type_name, std::move(func))) {
+                    return false;
+                }
+                m_estimates.emplace(map_type_name, std::move(estimate));
+                return true;
+            }
+
             bool has_map_type(const std::string& map_type_name) const {
                 return m_callbacks.count(map_type_name) != 0;
             }
@@ -262,6 +308,72 @@ namespace osmium {
                 throw map_factory_error{std::string{"Support for map type '"} + config[0] + "' not compiled into this binary"};
             }
 
+            /**
+             * Estimate how much memory a map of the given type would need.
+             *
+             * @param map_type_name Name of the map type.
+             * @param num_entries Expected number of entries.
+             * @param max_id Expected largest id.
+             * @returns Estimated memory use in bytes or 0 if there is no
+             *          estimate for this map type. There are no estimates
+             *          for map types storing their data in files.
+             * @throws map_factory_error if the map type is not known.
+             */
+            std::size_t estimate_memory(const std::string& map_type_name, const std::size_t num_entries, const id_type max_id) const {
+                if (!has_map_type(map_type_name)) {
+                    throw map_factory_error{std::string{"Support for map type '"} + map_type_name + "' not compiled into this binary"};
+                }
+
+                const auto it = m_estimates.find(map_type_name);
+                if (it == m_estimates.end()) {
+                    return 0;
+                }
+
+                return (it->second)(num_entries, max_id);
+            }
+
+            /**
+             * Select the map type from the candidates which needs the least
+             * memory for the expected input. Map types without an estimate
+             * are ignored. Get the number of entries and the largest id
+             * from a pre-scan of the input or from earlier runs with
+             * similar data.
+             *
+             * @param num_entries Expected number of entries.
+             * @param max_id Expected largest id.
+             * @param candidates Names of the map types to choose from.
+             * @returns Name of the selected map type.
+             * @throws map_factory_error if none of the candidates has an
+             *         estimate.
+             */
+            std::string select_map(const std::size_t num_entries, const id_type max_id, const std::vector<std::string>& candidates) const {
+                std::string best;
+                std::size_t best_memory = 0;
+
+                for (const auto& name : candidates) {
+                    const auto memory = estimate_memory(name, num_entries, max_id);
+                    if (memory != 0 && (best.empty() || memory < best_memory)) {
+                        best = name;
+                        best_memory = memory;
+                    }
+                }
+
+                if (best.empty()) {
+                    throw map_factory_error{"No map type with memory estimate available"};
+                }
+
+                return best;
+            }
+
+            /**
+             * Select the map type from all registered map types which needs
+             * the least memory for the expected input. See the other
+             * select_map() function for details.
+             */
+            std::string select_map(const std::size_t num_entries, const id_type max_id) const {
+                return select_map(num_entries, max_id, map_types());
+            }
+
         }; // class MapFactory
 
         namespace map {
@@ -273,12 +385,27 @@ namespace osmium {
                 }
             };
 
+            /**
+             * Estimate the memory in bytes a map of type TMap would need
+             * for num_entries entries with ids up to max_id. Specialize this
+             * for map types that can give an estimate. The default returns
+             * 0 meaning there is no estimate.
+             */
+            template <typename TId, typename TValue, template <typename, typename> class TMap>
+            struct estimate_memory {
+                std::size_t operator()(const std::size_t /*num_entries*/, const TId /*max_id*/) const noexcept {
+                    return 0;
+                }
+            };
+
         } // namespace map
 
         template <typename TId, typename TValue, template <typename, typename> class TMap>
         inline bool register_map(const std::string& name) {
             return osmium::index::MapFactory<TId, TValue>::instance().register_map(name, [](const std::vector<std::string>& config) {
                 return map::create_map<TId, TValue, TMap>()(config);
+            }, [](const std::size_t num_entries, const TId max_id) {
+                return map::estimate_memory<TId, TValue, TMap>()(num_entries, max_id);
             });
         }
 
@@ -33,14 +33,21 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/map/dense_concurrent_array.hpp> // IWYU pragma: keep
 #include <osmium/index/map/dense_file_array.hpp>  // IWYU pragma: keep
 #include <osmium/index/map/dense_mem_array.hpp>   // IWYU pragma: keep
 #include <osmium/index/map/dense_mmap_array.hpp>  // IWYU pragma: keep
+#include <osmium/index/map/dense_paged_array.hpp> // IWYU pragma: keep
 #include <osmium/index/map/dummy.hpp>             // IWYU pragma: keep
 #include <osmium/index/map/flex_mem.hpp>          // IWYU pragma: keep
+#include <osmium/index/map/location_cache.hpp>    // IWYU pragma: keep
 #include <osmium/index/map/sparse_file_array.hpp> // IWYU pragma: keep
 #include <osmium/index/map/sparse_mem_array.hpp>  // IWYU pragma: keep
+#include <osmium/index/map/sparse_mem_compressed.hpp> // IWYU pragma: keep
+#include <osmium/index/map/sparse_mem_hash.hpp>   // IWYU pragma: keep
+#include <osmium/index/map/sparse_mem_interpolated.hpp> // IWYU pragma: keep
 #include <osmium/index/map/sparse_mem_map.hpp>    // IWYU pragma: keep
 #include <osmium/index/map/sparse_mmap_array.hpp> // IWYU pragma: keep
+#include <osmium/index/map/updatable_location_cache.hpp> // IWYU pragma: keep
 
 #endif // OSMIUM_INDEX_MAP_ALL_HPP
@@ -0,0 +1,278 @@
+#ifndef OSMIUM_INDEX_MAP_DENSE_CONCURRENT_ARRAY_HPP
+#define OSMIUM_INDEX_MAP_DENSE_CONCURRENT_ARRAY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/memory_mapping.hpp>
+#include <osmium/util/misc.hpp>
+#include <osmium/util/prefetch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_DENSE_CONCURRENT_ARRAY
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Dense index that allows concurrent calls to set() from several
+             * threads without any locking. This can be used to fill a node
+             * location index from several threads working on different
+             * buffers at the same time.
+             *
+             * Unlike the other dense indexes this index does not grow
+             * automatically, you have to give it the maximum Id you want
+             * to store when creating it (or call reserve() before any
+             * data is stored). Calling set() with a larger Id will throw
+             * an std::out_of_range exception. The memory is allocated with
+             * an anonymous memory mapping. Values are stored in a way that
+             * an all-zero value means "empty", so the operating system only
+             * has to provide memory for pages that actually contain data.
+             *
+             * Only set(), get(), get_noexcept() and get_noexcept_bulk() can
+             * be called concurrently. If the same Id is set from several
+             * threads at the same time, one of the values will win.
+             *
+             * The value type must have the same size as uint64_t (for
+             * instance osmium::Location).
+             */
+            template <typename TId, typename TValue>
+            class DenseConcurrentArray : public osmium::index::map::Map<TId, TValue> {
+
+                static_assert(sizeof(TValue) == sizeof(uint64_t), "DenseConcurrentArray needs value type with the size of uint64_t");
+
+                using atomic_type = std::atomic<uint64_t>;
+
+                static_assert(sizeof(atomic_type) == sizeof(uint64_t), "std::atomic<uint64_t> must have the same size as uint64_t");
+                static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "std::atomic<uint64_t> must be lock-free");
+
+                // How many ids to look ahead in get_noexcept_bulk().
+                enum : std::size_t {
+                    prefetch_distance = 8
+                };
+
+                osmium::MemoryMapping m_mapping;
+                std::size_t m_capacity;
+
+                static uint64_t empty_bits() noexcept {
+                    const TValue empty = osmium::index::empty_value<TValue>();
+                    uint64_t bits = 0;
+                    std::memcpy(&bits, &empty, sizeof(uint64_t));
+                    return bits;
+                }
+
+                // Values are XOR'ed with the empty value, so that empty
+                // values are stored as all zero bits.
+                static uint64_t encode(const TValue value) noexcept {
+                    uint64_t bits = 0;
+                    std::memcpy(&bits, &value, sizeof(uint64_t));
+                    return bits ^ empty_bits();
+                }
+
+                static TValue decode(const uint64_t bits) noexcept {
+                    const uint64_t value_bits = bits ^ empty_bits();
+                    TValue value;
+                    std::memcpy(static_cast<void*>(&value), &value_bits, sizeof(uint64_t));
+                    return value;
+                }
+
+                atomic_type* data() const noexcept {
+                    return m_mapping.get_addr<atomic_type>();
+                }
+
+                static std::size_t bytes(const std::size_t capacity) noexcept {
+                    return capacity * sizeof(atomic_type);
+                }
+
+            public:
+
+                /**
+                 * Create index.
+                 *
+                 * @param max_id The largest Id that can be stored in this
+                 *               index.
+                 */
+                explicit DenseConcurrentArray(const TId max_id) :
+                    m_mapping(bytes(static_cast<std::size_t>(max_id) + 1), osmium::MemoryMapping::mapping_mode::write_private),
+                    m_capacity(static_cast<std::size_t>(max_id) + 1) {
+                }
+
+                /**
+                 * Create empty index. Call reserve() before storing any
+                 * data.
+                 */
+                DenseConcurrentArray() :
+                    m_mapping(0, osmium::MemoryMapping::mapping_mode::write_private),
+                    m_capacity(0) {
+                }
+
+                /**
+                 * Make sure Ids up to size - 1 can be stored. This must not
+                 * be called while other threads access the index.
+                 */
+                void reserve(const std::size_t size) final {
+                    if (size <= m_capacity) {
+                        return;
+                    }
+                    osmium::MemoryMapping new_mapping{bytes(size), osmium::MemoryMapping::mapping_mode::write_private};
+                    if (m_capacity > 0) {
+                        std::memcpy(new_mapping.get_addr<char>(), m_mapping.get_addr<char>(), bytes(m_capacity));
+                    }
+                    m_mapping = std::move(new_mapping);
+                    m_capacity = size;
+                }
+
+                /**
+                 * Set the value for the given id. This can be called from
+                 * several threads at the same time.
+                 *
+                 * @throws std::out_of_range if the id is larger than the
+                 *         maximum Id given in the constructor.
+                 */
+                void set(const TId id, const TValue value) final {
+                    if (id >= m_capacity) {
+                        throw std::out_of_range{"Id " + std::to_string(id) + " too large for DenseConcurrentArray"};
+                    }
+                    data()[id].store(encode(value), std::memory_order_relaxed);
+                }
+
+                TValue get(const TId id) const final {
+                    const TValue value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (id >= m_capacity) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return decode(data()[id].load(std::memory_order_relaxed));
+                }
+
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    const std::size_t ahead = std::min(count, static_cast<std::size_t>(prefetch_distance));
+                    for (std::size_t i = 0; i < ahead; ++i) {
+                        prefetch(ids[i]);
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i + ahead < count) {
+                            prefetch(ids[i + ahead]);
+                        }
+                        values[i] = get_noexcept(ids[i]);
+                    }
+                }
+
+                void prefetch(const TId id) const noexcept final {
+                    if (id < m_capacity) {
+                        osmium::prefetch(data() + id);
+                    }
+                }
+
+                /**
+                 * The number of Ids that can be stored in this index, ie
+                 * the maximum Id + 1.
+                 */
+                std::size_t size() const noexcept final {
+                    return m_capacity;
+                }
+
+                /**
+                 * The memory reserved for this index. The operating system
+                 * will only provide memory for the parts actually used.
+                 */
+                std::size_t used_memory() const noexcept final {
+                    return bytes(m_capacity);
+                }
+
+                void clear() final {
+                    m_mapping = osmium::MemoryMapping{0, osmium::MemoryMapping::mapping_mode::write_private};
+                    m_capacity = 0;
+                }
+
+                void dump_as_array(const int fd) final {
+                    constexpr const std::size_t buffer_size = (10UL * 1024UL * 1024UL) / sizeof(TValue);
+                    std::vector<TValue> buffer;
+                    buffer.reserve(buffer_size);
+
+                    for (std::size_t id = 0; id < m_capacity;) {
+                        buffer.clear();
+                        for (; id < m_capacity && buffer.size() < buffer_size; ++id) {
+                            buffer.push_back(get_noexcept(static_cast<TId>(id)));
+                        }
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(buffer.data()), sizeof(TValue) * buffer.size());
+                    }
+                }
+
+            }; // class DenseConcurrentArray
+
+            template <typename TId, typename TValue>
+            struct create_map<TId, TValue, DenseConcurrentArray> {
+                DenseConcurrentArray<TId, TValue>* operator()(const std::vector<std::string>& config) {
+                    if (config.size() < 2) {
+                        return new DenseConcurrentArray<TId, TValue>{};
+                    }
+                    const auto max_id = osmium::detail::str_to_int<TId>(config[1].c_str());
+                    if (max_id == 0) {
+                        throw map_factory_error{"Need maximum Id for dense_concurrent_array (like 'dense_concurrent_array,20000000000')"};
+                    }
+                    return new DenseConcurrentArray<TId, TValue>{max_id};
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseConcurrentArray, dense_concurrent_array)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_DENSE_CONCURRENT_ARRAY_HPP
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/index/detail/vector_map.hpp>
 
+#include <cstddef>
 #include <vector>
 
 #define OSMIUM_HAS_INDEX_MAP_DENSE_MEM_ARRAY
@@ -48,6 +49,14 @@ namespace osmium {
             template <typename TId, typename TValue>
             using DenseMemArray = VectorBasedDenseMap<std::vector<TValue>, TId, TValue>;
 
+            // Dense arrays need space for all Ids up to max_id.
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, DenseMemArray> {
+                std::size_t operator()(const std::size_t /*num_entries*/, const TId max_id) const noexcept {
+                    return (static_cast<std::size_t>(max_id) + 1) * sizeof(TValue);
+                }
+            };
+
         } // namespace map
 
     } // namespace index
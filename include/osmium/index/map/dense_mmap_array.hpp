@@ -38,6 +38,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/index/detail/mmap_vector_anon.hpp> // IWYU pragma: keep
 #include <osmium/index/detail/vector_map.hpp>
 
+#include <cstddef>
+
 #define OSMIUM_HAS_INDEX_MAP_DENSE_MMAP_ARRAY
 
 namespace osmium {
@@ -49,6 +51,14 @@ namespace osmium {
             template <typename TId, typename TValue>
             using DenseMmapArray = VectorBasedDenseMap<osmium::detail::mmap_vector_anon<TValue>, TId, TValue>;
 
+            // Dense arrays need space for all Ids up to max_id.
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, DenseMmapArray> {
+                std::size_t operator()(const std::size_t /*num_entries*/, const TId max_id) const noexcept {
+                    return (static_cast<std::size_t>(max_id) + 1) * sizeof(TValue);
+                }
+            };
+
         } // namespace map
 
     } // namespace index
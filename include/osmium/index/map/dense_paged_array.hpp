@@ -0,0 +1,388 @@
+#ifndef OSMIUM_INDEX_MAP_DENSE_PAGED_ARRAY_HPP
+#define OSMIUM_INDEX_MAP_DENSE_PAGED_ARRAY_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/create_map_with_fd.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+#include <osmium/util/prefetch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_DENSE_PAGED_ARRAY
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Dense index which only allocates memory for the ranges of Ids
+             * actually used. The Id space is split into pages of 2^16 Ids.
+             * A page table contains a pointer to each page, pages are
+             * allocated when the first Id in them is set. Each page
+             * contains a bitmap telling which Ids in the page are set
+             * followed by the values. Lookups are O(1): one access to the
+             * page table (which is small and usually in the CPU cache), one
+             * to the bitmap, and one to the value.
+             *
+             * Compared to the DenseMmapArray this needs memory proportional
+             * to the number of pages in use instead of to the largest Id,
+             * which makes a big difference for regional extracts. Because
+             * of the bitmap there is no need for a special "empty" value.
+             *
+             * Pages are handed out from larger memory mappings (chunks)
+             * which double in size up to max_chunk_pages pages. This keeps
+             * the number of mappings low even for the planet, the kernel
+             * limits how many mappings a process can have.
+             *
+             * The pages can optionally be stored in a file instead of in
+             * anonymous memory. In that case the chunks are stored in the
+             * file one after the other in the order they were allocated, so
+             * the file only grows with the number of pages in use. The file
+             * is only used as backing storage for the index, it can not be
+             * opened again as an index later. Existing contents of the file
+             * are discarded.
+             *
+             * The value type must be trivially copyable.
+             */
+            template <typename TId, typename TValue>
+            class DensePagedArray : public osmium::index::map::Map<TId, TValue> {
+
+            public:
+
+                enum : std::size_t {
+                    page_bits = 16,
+                    page_ids = std::size_t(1) << page_bits,
+                    bitmap_words = page_ids / 64
+                };
+
+            private:
+
+                // How many ids to look ahead in get_noexcept_bulk().
+                enum : std::size_t {
+                    prefetch_distance = 8
+                };
+
+                // Maximum number of pages in one chunk.
+                enum : std::size_t {
+                    max_chunk_pages = 1024
+                };
+
+                // The memory mappings holding the pages in the order they
+                // were allocated.
+                std::vector<osmium::MemoryMapping> m_chunks;
+
+                // Page table pointing to the start of each page or nullptr.
+                std::vector<char*> m_pages;
+
+                // Size of a page in bytes (rounded up to the system page
+                // size).
+                std::size_t m_page_bytes;
+
+                // Number of entries set.
+                std::size_t m_size = 0;
+
+                // Number of pages in use.
+                std::size_t m_num_pages = 0;
+
+                // Number of pages in all chunks.
+                std::size_t m_chunk_pages = 0;
+
+                // Next unused page in the last chunk.
+                char* m_next_page = nullptr;
+
+                // File descriptor of backing file or -1.
+                int m_fd = -1;
+
+                static std::size_t page_bytes() {
+                    const std::size_t bytes = bitmap_words * sizeof(uint64_t) + page_ids * sizeof(TValue);
+                    const std::size_t system_page_size = osmium::get_pagesize();
+                    return (bytes + system_page_size - 1) / system_page_size * system_page_size;
+                }
+
+                static std::size_t page_num(const TId id) noexcept {
+                    return static_cast<std::size_t>(id >> page_bits);
+                }
+
+                static std::size_t offset(const TId id) noexcept {
+                    return static_cast<std::size_t>(id) & (page_ids - 1);
+                }
+
+                static uint64_t* bitmap(char* page) noexcept {
+                    return reinterpret_cast<uint64_t*>(page);
+                }
+
+                static const uint64_t* bitmap(const char* page) noexcept {
+                    return reinterpret_cast<const uint64_t*>(page);
+                }
+
+                static TValue* values(char* page) noexcept {
+                    return reinterpret_cast<TValue*>(page + bitmap_words * sizeof(uint64_t));
+                }
+
+                static const TValue* values(const char* page) noexcept {
+                    return reinterpret_cast<const TValue*>(page + bitmap_words * sizeof(uint64_t));
+                }
+
+                static bool is_set(const char* page, const std::size_t pos) noexcept {
+                    return (bitmap(page)[pos >> 6U] & (1ULL << (pos & 0x3fU))) != 0;
+                }
+
+                const char* find_page(const TId id) const noexcept {
+                    const std::size_t num = page_num(id);
+                    if (num >= m_pages.size()) {
+                        return nullptr;
+                    }
+                    return m_pages[num];
+                }
+
+                char* assure_page(const TId id) {
+                    const std::size_t num = page_num(id);
+                    if (num >= m_pages.size()) {
+                        m_pages.resize(num + 1, nullptr);
+                    }
+                    if (!m_pages[num]) {
+                        if (m_num_pages == m_chunk_pages) {
+                            add_chunk();
+                        }
+                        m_pages[num] = m_next_page;
+                        m_next_page += m_page_bytes;
+                        ++m_num_pages;
+                    }
+                    return m_pages[num];
+                }
+
+                void add_chunk() {
+                    const std::size_t pages = std::min(std::max(m_chunk_pages, std::size_t(1)),
+                                                       static_cast<std::size_t>(max_chunk_pages));
+                    if (m_fd == -1) {
+                        m_chunks.emplace_back(pages * m_page_bytes, osmium::MemoryMapping::mapping_mode::write_private);
+                    } else {
+                        const auto file_offset = static_cast<off_t>(m_chunk_pages * m_page_bytes);
+                        m_chunks.emplace_back(pages * m_page_bytes, osmium::MemoryMapping::mapping_mode::write_shared, m_fd, file_offset);
+                    }
+                    m_chunk_pages += pages;
+                    m_next_page = m_chunks.back().get_addr<char>();
+                }
+
+                void prefetch_value(const TId id) const noexcept {
+                    const char* page = find_page(id);
+                    if (page) {
+                        osmium::prefetch(&values(page)[offset(id)]);
+                    }
+                }
+
+            public:
+
+                /**
+                 * Create index keeping all pages in memory.
+                 */
+                DensePagedArray() :
+                    m_page_bytes(page_bytes()) {
+                }
+
+                /**
+                 * Create index keeping the pages in the file with the given
+                 * file descriptor. The file is truncated. The file
+                 * descriptor is not closed by the index.
+                 */
+                explicit DensePagedArray(const int fd) :
+                    m_page_bytes(page_bytes()),
+                    m_fd(fd) {
+                    osmium::resize_file(fd, 0);
+                }
+
+                ~DensePagedArray() noexcept override = default;
+
+                void set(const TId id, const TValue value) final {
+                    char* page = assure_page(id);
+                    const std::size_t pos = offset(id);
+                    uint64_t& word = bitmap(page)[pos >> 6U];
+                    const uint64_t mask = 1ULL << (pos & 0x3fU);
+                    if ((word & mask) == 0) {
+                        word |= mask;
+                        ++m_size;
+                    }
+                    values(page)[pos] = value;
+                }
+
+                TValue get(const TId id) const final {
+                    const char* page = find_page(id);
+                    if (!page || !is_set(page, offset(id))) {
+                        throw osmium::not_found{id};
+                    }
+                    return values(page)[offset(id)];
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const char* page = find_page(id);
+                    if (!page || !is_set(page, offset(id))) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return values(page)[offset(id)];
+                }
+
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* result) const noexcept final {
+                    const std::size_t ahead = std::min(count, static_cast<std::size_t>(prefetch_distance));
+                    for (std::size_t i = 0; i < ahead; ++i) {
+                        prefetch_value(ids[i]);
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i + ahead < count) {
+                            prefetch_value(ids[i + ahead]);
+                        }
+                        result[i] = get_noexcept(ids[i]);
+                    }
+                }
+
+                void prefetch(const TId id) const noexcept final {
+                    prefetch_value(id);
+                }
+
+                /**
+                 * The number of entries set in the index.
+                 */
+                std::size_t size() const noexcept final {
+                    return m_size;
+                }
+
+                /**
+                 * The number of pages allocated.
+                 */
+                std::size_t num_pages() const noexcept {
+                    return m_num_pages;
+                }
+
+                /**
+                 * The number of memory mappings used for the pages.
+                 */
+                std::size_t num_chunks() const noexcept {
+                    return m_chunks.size();
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    return m_chunk_pages * m_page_bytes + m_pages.capacity() * sizeof(char*);
+                }
+
+                /**
+                 * Estimate the memory a DensePagedArray index needs for
+                 * num_entries entries with Ids up to max_id. This assumes
+                 * the worst case that the entries are spread over as many
+                 * pages as possible.
+                 */
+                static std::size_t estimate_memory(const std::size_t num_entries, const TId max_id) {
+                    const std::size_t max_pages = page_num(max_id) + 1;
+                    return std::min(max_pages, num_entries) * page_bytes() + max_pages * sizeof(char*);
+                }
+
+                void clear() final {
+                    m_pages.clear();
+                    m_pages.shrink_to_fit();
+                    m_chunks.clear();
+                    m_chunks.shrink_to_fit();
+                    m_size = 0;
+                    m_num_pages = 0;
+                    m_chunk_pages = 0;
+                    m_next_page = nullptr;
+                    if (m_fd != -1) {
+                        osmium::resize_file(m_fd, 0);
+                    }
+                }
+
+                void dump_as_array(const int fd) final {
+                    const std::unique_ptr<TValue[]> buffer{new TValue[page_ids]};
+                    for (const char* page : m_pages) {
+                        for (std::size_t pos = 0; pos < page_ids; ++pos) {
+                            buffer[pos] = (page && is_set(page, pos)) ? values(page)[pos] : osmium::index::empty_value<TValue>();
+                        }
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(buffer.get()), page_ids * sizeof(TValue));
+                    }
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::vector<std::pair<TId, TValue>> buffer;
+                    buffer.reserve(page_ids);
+                    for (std::size_t num = 0; num < m_pages.size(); ++num) {
+                        const char* page = m_pages[num];
+                        if (!page) {
+                            continue;
+                        }
+                        buffer.clear();
+                        for (std::size_t pos = 0; pos < page_ids; ++pos) {
+                            if (is_set(page, pos)) {
+                                buffer.emplace_back(static_cast<TId>((num << page_bits) + pos), values(page)[pos]);
+                            }
+                        }
+                        osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(std::pair<TId, TValue>));
+                    }
+                }
+
+            }; // class DensePagedArray
+
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, DensePagedArray> {
+                std::size_t operator()(const std::size_t num_entries, const TId max_id) const {
+                    return DensePagedArray<TId, TValue>::estimate_memory(num_entries, max_id);
+                }
+            };
+
+            template <typename TId, typename TValue>
+            struct create_map<TId, TValue, DensePagedArray> {
+                DensePagedArray<TId, TValue>* operator()(const std::vector<std::string>& config) {
+                    return osmium::index::detail::create_map_with_fd<DensePagedArray<TId, TValue>>(config);
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DensePagedArray, dense_paged_array)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_DENSE_PAGED_ARRAY_HPP
@@ -33,8 +33,10 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/index/detail/search.hpp>
 #include <osmium/index/index.hpp>
 #include <osmium/index/map.hpp>
+#include <osmium/util/prefetch.hpp>
 
 #include <algorithm>
 #include <cstddef>
@@ -48,6 +50,13 @@ namespace osmium {
 
     namespace index {
 
+        namespace detail {
+
+            template <typename TId, typename TValue>
+            struct flex_mem_parallel;
+
+        } // namespace detail
+
         namespace map {
 
             /**
@@ -60,6 +69,8 @@ namespace osmium {
             template <typename TId, typename TValue>
             class FlexMem : public osmium::index::map::Map<TId, TValue> {
 
+                friend struct osmium::index::detail::flex_mem_parallel<TId, TValue>;
+
                 // This value is based on benchmarks with a planet file and
                 // some smaller files.
                 enum {
@@ -70,19 +81,10 @@ namespace osmium {
                     block_size = 1ULL << bits
                 };
 
-                // Minimum number of entries in the sparse index before we
-                // are considering switching to a dense index.
-                enum : int64_t {
-                    min_dense_entries = 0xffffff
-                };
-
-                // When more than a third of all Ids are in the index, we
-                // switch to the dense index. This is a compromise between
-                // the best memory efficiency (which we would get at a factor
-                // of 2) and the performance (dense index is much faster then
-                // the sparse index).
-                enum {
-                    density_factor = 3
+                // How many ids to look ahead in get_noexcept_bulk() in dense
+                // mode.
+                enum : std::size_t {
+                    prefetch_distance = 8
                 };
 
                 // An entry in the sparse index
@@ -90,6 +92,8 @@ namespace osmium {
                     uint64_t id;
                     TValue value;
 
+                    entry() = default;
+
                     entry(uint64_t i, TValue v) :
                         id(i),
                         value(std::move(v)) {
@@ -107,6 +111,14 @@ namespace osmium {
                 // The maximum Id that was seen yet. Only set in sparse mode.
                 uint64_t m_max_id = 0;
 
+                // Minimum number of entries in the sparse index before we
+                // are considering switching to a dense index.
+                std::size_t m_min_dense_entries;
+
+                // Switch to the dense index when more than 1/m_density_factor
+                // of all Ids are in the index.
+                std::size_t m_density_factor;
+
                 // Set to false in sparse mode and to true in dense mode.
                 bool m_dense;
 
@@ -134,8 +146,8 @@ namespace osmium {
                     if (id > m_max_id) {
                         m_max_id = id;
 
-                        if (m_sparse_entries.size() >= min_dense_entries) {
-                            if (m_max_id < m_sparse_entries.size() * density_factor) {
+                        if (m_sparse_entries.size() >= m_min_dense_entries) {
+                            if (m_max_id < m_sparse_entries.size() * m_density_factor) {
                                 switch_to_dense();
                             }
                         }
@@ -164,8 +176,27 @@ namespace osmium {
                     return m_dense_blocks[block(id)][offset(id)];
                 }
 
+                void prefetch_dense(const uint64_t id) const noexcept {
+                    if (block(id) < m_dense_blocks.size() && !m_dense_blocks[block(id)].empty()) {
+                        osmium::prefetch(&m_dense_blocks[block(id)][offset(id)]);
+                    }
+                }
+
             public:
 
+                enum : std::size_t {
+                    // Default minimum number of entries in the sparse index
+                    // before we are considering switching to a dense index.
+                    default_min_dense_entries = 0xffffff,
+
+                    // When more than a third of all Ids are in the index, we
+                    // switch to the dense index. This is a compromise between
+                    // the best memory efficiency (which we would get at a
+                    // factor of 2) and the performance (dense index is much
+                    // faster then the sparse index).
+                    default_density_factor = 3
+                };
+
                 /**
                  * Create FlexMem index.
                  *
@@ -174,8 +205,19 @@ namespace osmium {
                  *                  think it is better. Set this to force dense
                  *                  indexing from the start. This is usually
                  *                  only useful for testing.
+                 * @param min_dense_entries Minimum number of entries before
+                 *                          switching to dense indexing is
+                 *                          considered.
+                 * @param density_factor Switch to dense indexing when more
+                 *                       than 1/density_factor of all Ids
+                 *                       up to the largest Id seen are in
+                 *                       the index.
                  */
-                explicit FlexMem(bool use_dense = false) :
+                explicit FlexMem(bool use_dense = false,
+                                 std::size_t min_dense_entries = default_min_dense_entries,
+                                 std::size_t density_factor = default_density_factor) :
+                    m_min_dense_entries(min_dense_entries),
+                    m_density_factor(density_factor),
                     m_dense(use_dense) {
                 }
 
@@ -196,6 +238,22 @@ namespace osmium {
                            m_dense_blocks.size() * (block_size * sizeof(TValue) + sizeof(std::vector<TValue>));
                 }
 
+                /**
+                 * Estimate the memory a FlexMem index with the given
+                 * settings needs for num_entries entries with Ids up to
+                 * max_id. This assumes that all dense blocks are used.
+                 */
+                static std::size_t estimate_memory(const std::size_t num_entries,
+                                                   const TId max_id,
+                                                   const std::size_t min_dense_entries = default_min_dense_entries,
+                                                   const std::size_t density_factor = default_density_factor) noexcept {
+                    if (num_entries >= min_dense_entries && max_id < num_entries * density_factor) {
+                        return sizeof(FlexMem) +
+                               (block(max_id) + 1) * (block_size * sizeof(TValue) + sizeof(std::vector<TValue>));
+                    }
+                    return sizeof(FlexMem) + num_entries * sizeof(entry);
+                }
+
                 void set(const TId id, const TValue value) final {
                     if (m_dense) {
                         set_dense(id, value);
@@ -211,6 +269,43 @@ namespace osmium {
                     return get_sparse(id);
                 }
 
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    if (m_dense) {
+                        const std::size_t ahead = std::min(count, static_cast<std::size_t>(prefetch_distance));
+                        for (std::size_t i = 0; i < ahead; ++i) {
+                            prefetch_dense(ids[i]);
+                        }
+                        for (std::size_t i = 0; i < count; ++i) {
+                            if (i + ahead < count) {
+                                prefetch_dense(ids[i + ahead]);
+                            }
+                            values[i] = get_dense(ids[i]);
+                        }
+                        return;
+                    }
+
+                    auto it = m_sparse_entries.cbegin();
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i == 0 || ids[i] < ids[i - 1]) {
+                            it = m_sparse_entries.cbegin();
+                        }
+                        it = osmium::index::detail::gallop_lower_bound(it, m_sparse_entries.cend(), static_cast<uint64_t>(ids[i]), [](const entry& e) {
+                            return e.id;
+                        });
+                        if (it == m_sparse_entries.cend() || it->id != ids[i]) {
+                            values[i] = osmium::index::empty_value<TValue>();
+                        } else {
+                            values[i] = it->value;
+                        }
+                    }
+                }
+
+                void prefetch(const TId id) const noexcept final {
+                    if (m_dense) {
+                        prefetch_dense(id);
+                    }
+                }
+
                 TValue get(const TId id) const final {
                     const auto value = get_noexcept(id);
                     if (value == osmium::index::empty_value<TValue>()) {
@@ -270,6 +365,13 @@ namespace osmium {
 
             }; // class FlexMem
 
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, FlexMem> {
+                std::size_t operator()(const std::size_t num_entries, const TId max_id) const noexcept {
+                    return FlexMem<TId, TValue>::estimate_memory(num_entries, max_id);
+                }
+            };
+
         } // namespace map
 
     } // namespace index
@@ -0,0 +1,676 @@
+#ifndef OSMIUM_INDEX_MAP_LOCATION_CACHE_HPP
+#define OSMIUM_INDEX_MAP_LOCATION_CACHE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/search.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/util/compatibility.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a location cache file can not be read or
+     * written.
+     */
+    struct OSMIUM_EXPORT location_cache_error : public std::runtime_error {
+
+        explicit location_cache_error(const char* message) :
+            std::runtime_error(message) {
+        }
+
+        explicit location_cache_error(const std::string& message) :
+            std::runtime_error(message) {
+        }
+
+    }; // struct location_cache_error
+
+    namespace index {
+
+        namespace detail {
+
+            inline uint64_t checksum_rotl(const uint64_t value, const unsigned int bits) noexcept {
+                return (value << bits) | (value >> (64U - bits));
+            }
+
+            inline uint64_t checksum_round(uint64_t acc, const uint64_t input) noexcept {
+                acc += input * 0xc2b2ae3d27d4eb4fULL;
+                acc = checksum_rotl(acc, 31);
+                return acc * 0x9e3779b185ebca87ULL;
+            }
+
+            inline uint64_t checksum_read(const char* data) noexcept {
+                uint64_t value = 0;
+                std::memcpy(&value, data, sizeof(uint64_t));
+                return value;
+            }
+
+            /**
+             * Calculate a 64 bit checksum of some data. This is not a
+             * cryptographic hash, it is only used to detect corrupted or
+             * truncated files. It uses the round function of the xxHash64
+             * algorithm on four independent lanes, so it is fast enough
+             * for checking many GBytes of data.
+             */
+            inline uint64_t checksum64(const char* data, const std::size_t size) noexcept {
+                const char* const end = data + size;
+
+                uint64_t lane1 = 0x60ea27eeadc0b5d6ULL;
+                uint64_t lane2 = 0xc2b2ae3d27d4eb4fULL;
+                uint64_t lane3 = 0;
+                uint64_t lane4 = 0x61c8864e7a143579ULL;
+
+                for (; end - data >= 32; data += 32) {
+                    lane1 = checksum_round(lane1, checksum_read(data));
+                    lane2 = checksum_round(lane2, checksum_read(data + 8));
+                    lane3 = checksum_round(lane3, checksum_read(data + 16));
+                    lane4 = checksum_round(lane4, checksum_read(data + 24));
+                }
+
+                uint64_t hash = checksum_rotl(lane1, 1) + checksum_rotl(lane2, 7) +
+                                checksum_rotl(lane3, 12) + checksum_rotl(lane4, 18);
+                hash += static_cast<uint64_t>(size);
+
+                for (; end - data >= 8; data += 8) {
+                    hash ^= checksum_round(0, checksum_read(data));
+                    hash = checksum_rotl(hash, 27) * 0x9e3779b185ebca87ULL + 0x85ebca77c2b2ae63ULL;
+                }
+
+                for (; data != end; ++data) {
+                    hash ^= static_cast<uint64_t>(static_cast<unsigned char>(*data)) * 0x27d4eb2f165667c5ULL;
+                    hash = checksum_rotl(hash, 11) * 0x9e3779b185ebca87ULL;
+                }
+
+                hash ^= hash >> 33U;
+                hash *= 0xc2b2ae3d27d4eb4fULL;
+                hash ^= hash >> 29U;
+                hash *= 0x165667b19e3779f9ULL;
+                hash ^= hash >> 32U;
+
+                return hash;
+            }
+
+        } // namespace detail
+
+        namespace map {
+
+            /// The layout of the data in a location cache file.
+            enum class location_cache_type : uint32_t {
+                dense  = 1, ///< array of values indexed by id
+                sparse = 2  ///< list of (id, value) pairs sorted by id
+            };
+
+            /**
+             * Header at the beginning of a location cache file. All
+             * numbers are stored in the native byte order of the machine
+             * that wrote the file.
+             */
+            struct location_cache_header {
+
+                enum : uint32_t {
+                    current_version = 1,
+                    byte_order_mark = 0x01020304
+                };
+
+                /// Always "OSMLCACH"
+                char magic[8];
+
+                /// Version of the file format
+                uint32_t version;
+
+                /// Used to detect files written on a machine with another byte order
+                uint32_t byte_order;
+
+                /// The location_cache_type
+                uint32_t type;
+
+                /// Size of the id type in bytes
+                uint16_t id_size;
+
+                /// Size of the value type in bytes
+                uint16_t value_size;
+
+                /// Smallest id in the file (always 0 for dense files)
+                uint64_t min_id;
+
+                /// Largest id in the file
+                uint64_t max_id;
+
+                /// Number of entries (values or id/value pairs) in the file
+                uint64_t count;
+
+                /// Timestamp of the source data (seconds since the epoch)
+                uint64_t timestamp;
+
+                /// Checksum of the data following the header
+                uint64_t checksum;
+
+            }; // struct location_cache_header
+
+            static_assert(sizeof(location_cache_header) == 64, "location_cache_header must be 64 bytes");
+
+        } // namespace map
+
+        namespace detail {
+
+            constexpr const char location_cache_magic[] = "OSMLCACH";
+
+            template <typename TId, typename TValue>
+            std::size_t location_cache_entry_size(const osmium::index::map::location_cache_type type) noexcept {
+                return type == osmium::index::map::location_cache_type::dense ? sizeof(TValue) : sizeof(std::pair<TId, TValue>);
+            }
+
+            /**
+             * Truncate the file and write a preliminary header to it.
+             * The data has to be written after this, then call
+             * finish_location_cache().
+             */
+            template <typename TId, typename TValue>
+            osmium::index::map::location_cache_header start_location_cache(const int fd, const osmium::index::map::location_cache_type type, const osmium::Timestamp timestamp) {
+                osmium::index::map::location_cache_header header{};
+                std::memcpy(header.magic, location_cache_magic, sizeof(header.magic));
+                header.version = osmium::index::map::location_cache_header::current_version;
+                header.byte_order = osmium::index::map::location_cache_header::byte_order_mark;
+                header.type = static_cast<uint32_t>(type);
+                header.id_size = static_cast<uint16_t>(sizeof(TId));
+                header.value_size = static_cast<uint16_t>(sizeof(TValue));
+                header.timestamp = static_cast<uint64_t>(timestamp.seconds_since_epoch());
+
+                osmium::resize_file(fd, 0);
+                osmium::file_seek(fd, 0);
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+
+                return header;
+            }
+
+            /**
+             * Fill in the rest of the header from the data written
+             * after the header and write it into the file again.
+             */
+            template <typename TId, typename TValue>
+            void finish_location_cache(const int fd, osmium::index::map::location_cache_header& header) {
+                const auto type = static_cast<osmium::index::map::location_cache_type>(header.type);
+                const std::size_t file_size = osmium::file_size(fd);
+                const std::size_t data_size = file_size - sizeof(osmium::index::map::location_cache_header);
+                const std::size_t entry_size = location_cache_entry_size<TId, TValue>(type);
+                if (file_size < sizeof(osmium::index::map::location_cache_header) || data_size % entry_size != 0) {
+                    throw location_cache_error{"location cache data has wrong size"};
+                }
+                header.count = data_size / entry_size;
+
+                if (header.count > 0) {
+                    const osmium::MemoryMapping mapping{file_size, osmium::MemoryMapping::mapping_mode::readonly, fd};
+                    const char* data = mapping.get_addr<const char>() + sizeof(osmium::index::map::location_cache_header);
+                    header.checksum = checksum64(data, data_size);
+                    if (type == osmium::index::map::location_cache_type::dense) {
+                        header.max_id = header.count - 1;
+                    } else {
+                        const auto* elements = reinterpret_cast<const std::pair<TId, TValue>*>(data);
+                        header.min_id = static_cast<uint64_t>(elements[0].first);
+                        header.max_id = static_cast<uint64_t>(elements[header.count - 1].first);
+                    }
+                } else {
+                    header.checksum = checksum64(nullptr, 0);
+                }
+
+                osmium::file_seek(fd, 0);
+                osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(&header), sizeof(header));
+                osmium::file_seek(fd, file_size);
+            }
+
+        } // namespace detail
+
+        namespace map {
+
+            /**
+             * Write the contents of an index into a location cache file.
+             * The file will start with a location_cache_header describing
+             * the data followed by the data itself, either as an array of
+             * values (dense) or as a sorted list of id/value pairs
+             * (sparse). Use a LocationCache to read the file.
+             *
+             * The index will be sorted before it is written. Not all
+             * indexes support both types: The index must support
+             * dump_as_array() for dense files and dump_as_list() for
+             * sparse files.
+             *
+             * @param fd File descriptor of the file to write to. Must be
+             *           opened for reading and writing. Existing content
+             *           will be overwritten.
+             * @param index The index to write.
+             * @param type Write dense or sparse file.
+             * @param timestamp Timestamp of the source data. Stored in
+             *                  the header so users of the cache can check
+             *                  whether it is up to date.
+             * @returns The header written to the file.
+             * @throws std::system_error If the file can not be written.
+             * @throws location_cache_error If the data written has the
+             *         wrong size.
+             */
+            template <typename TId, typename TValue>
+            location_cache_header write_location_cache(const int fd, Map<TId, TValue>& index, const location_cache_type type, const osmium::Timestamp timestamp = osmium::Timestamp{}) {
+                location_cache_header header = osmium::index::detail::start_location_cache<TId, TValue>(fd, type, timestamp);
+
+                index.sort();
+                if (type == location_cache_type::dense) {
+                    index.dump_as_array(fd);
+                } else {
+                    index.dump_as_list(fd);
+                }
+
+                osmium::index::detail::finish_location_cache<TId, TValue>(fd, header);
+
+                return header;
+            }
+
+            /**
+             * Write a location cache file directly from (id, value) pairs
+             * sorted by id, for instance from the nodes in an OSM file.
+             * Unlike write_location_cache() this does not need an index
+             * holding all the data first, the entries are written to the
+             * file as they come in.
+             *
+             * Call close() after the last entry was added to fill in the
+             * header.
+             */
+            template <typename TId, typename TValue>
+            class LocationCacheWriter {
+
+                enum : std::size_t {
+                    max_buffer_size = 10UL * 1024UL * 1024UL
+                };
+
+                std::string m_buffer;
+                location_cache_header m_header;
+                int m_fd;
+                TId m_next_id = 0;
+                bool m_closed = false;
+
+                void append(const void* data, const std::size_t size) {
+                    m_buffer.append(reinterpret_cast<const char*>(data), size);
+                    if (m_buffer.size() >= max_buffer_size) {
+                        flush();
+                    }
+                }
+
+                void flush() {
+                    osmium::io::detail::reliable_write(m_fd, m_buffer.data(), m_buffer.size());
+                    m_buffer.clear();
+                }
+
+            public:
+
+                /**
+                 * Start writing a location cache file.
+                 *
+                 * @param fd File descriptor of the file to write to. Must be
+                 *           opened for reading and writing. Existing content
+                 *           will be overwritten.
+                 * @param type Write dense or sparse file.
+                 * @param timestamp Timestamp of the source data.
+                 * @throws std::system_error If the file can not be written.
+                 */
+                LocationCacheWriter(const int fd, const location_cache_type type, const osmium::Timestamp timestamp = osmium::Timestamp{}) :
+                    m_header(osmium::index::detail::start_location_cache<TId, TValue>(fd, type, timestamp)),
+                    m_fd(fd) {
+                    m_buffer.reserve(max_buffer_size);
+                }
+
+                LocationCacheWriter(const LocationCacheWriter&) = delete;
+                LocationCacheWriter& operator=(const LocationCacheWriter&) = delete;
+
+                LocationCacheWriter(LocationCacheWriter&&) = delete;
+                LocationCacheWriter& operator=(LocationCacheWriter&&) = delete;
+
+                /**
+                 * The destructor calls close() if it wasn't called before
+                 * and ignores any errors. Call close() explicitly to get
+                 * notified of errors.
+                 */
+                ~LocationCacheWriter() noexcept {
+                    try {
+                        close();
+                    } catch (...) {
+                        // Ignore any exceptions because destructor must not throw.
+                    }
+                }
+
+                /**
+                 * Add an entry to the file.
+                 *
+                 * @pre close() was not called.
+                 * @throws location_cache_error If the id is not larger than
+                 *         the id of the previous entry.
+                 * @throws std::system_error If the file can not be written.
+                 */
+                void set(const TId id, const TValue value) {
+                    assert(!m_closed);
+                    if (id < m_next_id) {
+                        throw location_cache_error{"ids for location cache must be strictly increasing"};
+                    }
+
+                    if (m_header.type == static_cast<uint32_t>(location_cache_type::dense)) {
+                        const TValue empty = osmium::index::empty_value<TValue>();
+                        for (; m_next_id < id; ++m_next_id) {
+                            append(&empty, sizeof(TValue));
+                        }
+                        append(&value, sizeof(TValue));
+                    } else {
+                        const std::pair<TId, TValue> element{id, value};
+                        append(&element, sizeof(element));
+                    }
+                    m_next_id = id + 1;
+                }
+
+                /**
+                 * Write out the remaining data and the final header. Does
+                 * nothing if called a second time.
+                 *
+                 * @returns The header written to the file.
+                 * @throws std::system_error If the file can not be written.
+                 */
+                location_cache_header close() {
+                    if (!m_closed) {
+                        m_closed = true;
+                        flush();
+                        osmium::index::detail::finish_location_cache<TId, TValue>(m_fd, m_header);
+                    }
+                    return m_header;
+                }
+
+            }; // class LocationCacheWriter
+
+            /**
+             * Read-only index using a location cache file written by
+             * write_location_cache(). The file is memory mapped, so the
+             * index is ready to use immediately after opening without
+             * reading the data. The header is checked when opening the
+             * file, call verify() to also check the data against the
+             * checksum in the header (this reads the whole file).
+             *
+             * Calling set() on this index will throw a
+             * location_cache_error.
+             */
+            template <typename TId, typename TValue>
+            class LocationCache : public osmium::index::map::Map<TId, TValue> {
+
+            public:
+
+                using element_type = std::pair<TId, TValue>;
+
+            private:
+
+                osmium::MemoryMapping m_mapping;
+                location_cache_header m_header;
+
+                static osmium::MemoryMapping map_file(const int fd) {
+                    const std::size_t size = osmium::file_size(fd);
+                    if (size < sizeof(location_cache_header)) {
+                        throw location_cache_error{"location cache file too small"};
+                    }
+                    return osmium::MemoryMapping{size, osmium::MemoryMapping::mapping_mode::readonly, fd};
+                }
+
+                static osmium::MemoryMapping open_and_map_file(const std::string& filename) {
+                    const int fd = osmium::io::detail::open_for_reading(filename);
+                    try {
+                        osmium::MemoryMapping mapping{map_file(fd)};
+                        osmium::io::detail::reliable_close(fd);
+                        return mapping;
+                    } catch (...) {
+                        osmium::io::detail::reliable_close(fd);
+                        throw;
+                    }
+                }
+
+                const char* data() const noexcept {
+                    return m_mapping.get_addr<const char>() + sizeof(location_cache_header);
+                }
+
+                const TValue* values() const noexcept {
+                    return reinterpret_cast<const TValue*>(data());
+                }
+
+                const element_type* elements_begin() const noexcept {
+                    return reinterpret_cast<const element_type*>(data());
+                }
+
+                const element_type* elements_end() const noexcept {
+                    return elements_begin() + m_header.count;
+                }
+
+                std::size_t data_size() const noexcept {
+                    return m_header.count * osmium::index::detail::location_cache_entry_size<TId, TValue>(type());
+                }
+
+                const element_type* find_id(const TId id) const noexcept {
+                    return std::lower_bound(elements_begin(), elements_end(), id, [](const element_type& element, const TId i) {
+                        return element.first < i;
+                    });
+                }
+
+                void check_header() const {
+                    if (std::memcmp(m_header.magic, osmium::index::detail::location_cache_magic, sizeof(m_header.magic)) != 0) {
+                        throw location_cache_error{"not a location cache file"};
+                    }
+                    if (m_header.version != location_cache_header::current_version) {
+                        throw location_cache_error{"unsupported location cache file version " + std::to_string(m_header.version)};
+                    }
+                    if (m_header.byte_order != location_cache_header::byte_order_mark) {
+                        throw location_cache_error{"location cache file was written on a machine with different byte order"};
+                    }
+                    if (m_header.type != static_cast<uint32_t>(location_cache_type::dense) &&
+                        m_header.type != static_cast<uint32_t>(location_cache_type::sparse)) {
+                        throw location_cache_error{"unknown location cache type " + std::to_string(m_header.type)};
+                    }
+                    if (m_header.id_size != sizeof(TId) || m_header.value_size != sizeof(TValue)) {
+                        throw location_cache_error{"location cache file has wrong id or value size"};
+                    }
+                    if (m_mapping.size() != sizeof(location_cache_header) + data_size()) {
+                        throw location_cache_error{"location cache file has wrong size (truncated?)"};
+                    }
+                }
+
+                explicit LocationCache(osmium::MemoryMapping&& mapping) :
+                    m_mapping(std::move(mapping)),
+                    m_header() {
+                    std::memcpy(&m_header, m_mapping.get_addr<const char>(), sizeof(location_cache_header));
+                    check_header();
+                }
+
+            public:
+
+                /**
+                 * Open location cache from a file descriptor. The file
+                 * descriptor can be closed after this, the index will
+                 * stay usable.
+                 *
+                 * @throws location_cache_error If the file is not a valid
+                 *         location cache file for this index type.
+                 */
+                explicit LocationCache(const int fd) :
+                    LocationCache(map_file(fd)) {
+                }
+
+                /**
+                 * Open location cache file with the given name.
+                 *
+                 * @throws std::system_error If the file can not be opened.
+                 * @throws location_cache_error If the file is not a valid
+                 *         location cache file for this index type.
+                 */
+                explicit LocationCache(const std::string& filename) :
+                    LocationCache(open_and_map_file(filename)) {
+                }
+
+                /// The header of the location cache file.
+                const location_cache_header& header() const noexcept {
+                    return m_header;
+                }
+
+                location_cache_type type() const noexcept {
+                    return static_cast<location_cache_type>(m_header.type);
+                }
+
+                /// The timestamp of the source data stored in the header.
+                osmium::Timestamp timestamp() const noexcept {
+                    return osmium::Timestamp{static_cast<uint32_t>(m_header.timestamp)};
+                }
+
+                /**
+                 * Check the data against the checksum in the header. For
+                 * sparse files also check that the ids are sorted. This
+                 * has to read the whole file.
+                 *
+                 * @returns true if the data is okay.
+                 */
+                bool verify() const noexcept {
+                    if (osmium::index::detail::checksum64(data(), data_size()) != m_header.checksum) {
+                        return false;
+                    }
+                    if (type() == location_cache_type::sparse) {
+                        return std::is_sorted(elements_begin(), elements_end(), [](const element_type& a, const element_type& b) {
+                            return a.first < b.first;
+                        });
+                    }
+                    return true;
+                }
+
+                /**
+                 * Call func(id, value) for all ids with a non-empty value
+                 * in order of ids.
+                 */
+                template <typename TFunc>
+                void for_each(TFunc&& func) const {
+                    if (type() == location_cache_type::dense) {
+                        for (std::size_t id = 0; id < m_header.count; ++id) {
+                            if (values()[id] != osmium::index::empty_value<TValue>()) {
+                                func(static_cast<TId>(id), values()[id]);
+                            }
+                        }
+                        return;
+                    }
+
+                    for (const element_type* it = elements_begin(); it != elements_end(); ++it) {
+                        func(it->first, it->second);
+                    }
+                }
+
+                void set(const TId /*id*/, const TValue /*value*/) final {
+                    throw location_cache_error{"can not change read-only location cache"};
+                }
+
+                TValue get(const TId id) const final {
+                    const TValue value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (type() == location_cache_type::dense) {
+                        if (id >= m_header.count) {
+                            return osmium::index::empty_value<TValue>();
+                        }
+                        return values()[id];
+                    }
+
+                    const element_type* it = find_id(id);
+                    if (it == elements_end() || it->first != id) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return it->second;
+                }
+
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values_out) const noexcept final {
+                    if (type() == location_cache_type::dense) {
+                        for (std::size_t i = 0; i < count; ++i) {
+                            values_out[i] = get_noexcept(ids[i]);
+                        }
+                        return;
+                    }
+
+                    const element_type* it = elements_begin();
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i == 0 || ids[i] < ids[i - 1]) {
+                            it = find_id(ids[i]);
+                        } else {
+                            it = osmium::index::detail::gallop_lower_bound(it, elements_end(), ids[i], [](const element_type& element) {
+                                return element.first;
+                            });
+                        }
+                        if (it == elements_end() || it->first != ids[i]) {
+                            values_out[i] = osmium::index::empty_value<TValue>();
+                        } else {
+                            values_out[i] = it->second;
+                        }
+                    }
+                }
+
+                std::size_t size() const noexcept final {
+                    return m_header.count;
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    return m_mapping.size();
+                }
+
+                void clear() final {
+                    m_mapping.unmap();
+                    m_header.count = 0;
+                }
+
+            }; // class LocationCache
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MAP_LOCATION_CACHE_HPP
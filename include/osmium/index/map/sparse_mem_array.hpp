@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/index/detail/vector_map.hpp>
 
+#include <cstddef>
 #include <vector>
 
 #define OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_ARRAY
@@ -51,6 +52,14 @@ namespace osmium {
             template <typename TId, typename TValue>
             using SparseMemArray = VectorBasedSparseMap<TId, TValue, StdVectorWrap>;
 
+            // Sparse arrays need space for an (id, value) pair per entry.
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, SparseMemArray> {
+                std::size_t operator()(const std::size_t num_entries, const TId /*max_id*/) const noexcept {
+                    return num_entries * sizeof(typename SparseMemArray<TId, TValue>::element_type);
+                }
+            };
+
         } // namespace map
 
     } // namespace index
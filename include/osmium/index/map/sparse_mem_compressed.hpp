@@ -0,0 +1,417 @@
+#ifndef OSMIUM_INDEX_MAP_SPARSE_MEM_COMPRESSED_HPP
+#define OSMIUM_INDEX_MAP_SPARSE_MEM_COMPRESSED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/index/detail/search.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/location.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_COMPRESSED
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Sparse index for node locations which stores Ids and locations
+             * in compressed form. The entries are kept sorted by Id in
+             * blocks of up to block_size entries. For each block a header
+             * is stored with the first Id and the minimum x and y
+             * coordinates in the block. The entries themselves are stored
+             * as differences to those values using only as many bits as
+             * needed for the largest difference in the block.
+             *
+             * Because nodes with similar Ids are usually close together, this
+             * typically needs only 5 to 6 bytes per entry instead of the 16
+             * bytes needed by the other sparse indexes. Lookups are a binary
+             * search over the block headers followed by a binary search
+             * inside the block, so they are somewhat slower than with the
+             * SparseMemArray.
+             *
+             * Works best when the Ids are set in order, which is the case
+             * when reading sorted OSM files. If Ids are not set in order,
+             * you have to call sort() before reading from the index. Sorting
+             * will temporarily need as much memory as the uncompressed
+             * data. If an Id is set several times, the last value wins.
+             *
+             * This index can only be used for osmium::Location values.
+             */
+            template <typename TId, typename TValue>
+            class SparseMemCompressed : public osmium::index::map::Map<TId, TValue> {
+
+                static_assert(std::is_same<TValue, osmium::Location>::value, "SparseMemCompressed only works with osmium::Location values");
+
+            public:
+
+                using element_type = typename std::pair<TId, TValue>;
+
+                // Number of entries in a block.
+                enum : std::size_t {
+                    block_size = 64
+                };
+
+            private:
+
+                struct block_header {
+                    uint64_t first_id;
+                    uint64_t word_offset;
+                    int32_t min_x;
+                    int32_t min_y;
+                    uint8_t id_bits;
+                    uint8_t x_bits;
+                    uint8_t y_bits;
+                    uint8_t count;
+
+                    unsigned int entry_bits() const noexcept {
+                        return static_cast<unsigned int>(id_bits) + x_bits + y_bits;
+                    }
+                }; // struct block_header
+
+                // Bit-packed entries of all blocks.
+                std::vector<uint64_t> m_words;
+
+                // Headers of all blocks, sorted by first Id.
+                std::vector<block_header> m_blocks;
+
+                // Sorted entries not yet packed into a block.
+                std::vector<element_type> m_pending;
+
+                // Entries that were set out of order. They are merged into
+                // the blocks when sort() is called.
+                std::vector<element_type> m_unsorted;
+
+                // Number of entries in m_blocks.
+                std::size_t m_packed_size = 0;
+
+                static uint64_t offset_x(const block_header& header, const TValue value) noexcept {
+                    return static_cast<uint64_t>(static_cast<int64_t>(value.x()) - header.min_x);
+                }
+
+                static uint64_t offset_y(const block_header& header, const TValue value) noexcept {
+                    return static_cast<uint64_t>(static_cast<int64_t>(value.y()) - header.min_y);
+                }
+
+                uint64_t bit_pos(const block_header& header, const std::size_t n) const noexcept {
+                    return header.word_offset * 64U + n * header.entry_bits();
+                }
+
+                TId id_at(const block_header& header, const std::size_t n) const noexcept {
+                    return static_cast<TId>(header.first_id + osmium::index::detail::read_bits(m_words.data(), bit_pos(header, n), header.id_bits));
+                }
+
+                TValue value_at(const block_header& header, const std::size_t n) const noexcept {
+                    const uint64_t pos = bit_pos(header, n) + header.id_bits;
+                    const auto x = static_cast<int64_t>(osmium::index::detail::read_bits(m_words.data(), pos, header.x_bits)) + header.min_x;
+                    const auto y = static_cast<int64_t>(osmium::index::detail::read_bits(m_words.data(), pos + header.x_bits, header.y_bits)) + header.min_y;
+                    return TValue{static_cast<int32_t>(x), static_cast<int32_t>(y)};
+                }
+
+                void pack_block(const element_type* begin, const element_type* end) {
+                    assert(begin != end && end - begin <= static_cast<std::ptrdiff_t>(block_size));
+
+                    block_header header{};
+                    header.first_id = begin->first;
+                    header.word_offset = m_words.size();
+                    header.count = static_cast<uint8_t>(end - begin);
+
+                    int32_t min_x = begin->second.x();
+                    int32_t max_x = min_x;
+                    int32_t min_y = begin->second.y();
+                    int32_t max_y = min_y;
+                    for (auto it = begin; it != end; ++it) {
+                        min_x = std::min(min_x, it->second.x());
+                        max_x = std::max(max_x, it->second.x());
+                        min_y = std::min(min_y, it->second.y());
+                        max_y = std::max(max_y, it->second.y());
+                    }
+                    header.min_x = min_x;
+                    header.min_y = min_y;
+
+                    header.id_bits = static_cast<uint8_t>(osmium::index::detail::bits_needed((end - 1)->first - begin->first));
+                    header.x_bits = static_cast<uint8_t>(osmium::index::detail::bits_needed(static_cast<uint64_t>(static_cast<int64_t>(max_x) - min_x)));
+                    header.y_bits = static_cast<uint8_t>(osmium::index::detail::bits_needed(static_cast<uint64_t>(static_cast<int64_t>(max_y) - min_y)));
+
+                    uint64_t pos = bit_pos(header, 0);
+                    for (auto it = begin; it != end; ++it) {
+                        osmium::index::detail::write_bits(m_words, pos, it->first - begin->first, header.id_bits);
+                        pos += header.id_bits;
+                        osmium::index::detail::write_bits(m_words, pos, offset_x(header, it->second), header.x_bits);
+                        pos += header.x_bits;
+                        osmium::index::detail::write_bits(m_words, pos, offset_y(header, it->second), header.y_bits);
+                        pos += header.y_bits;
+                    }
+
+                    m_blocks.push_back(header);
+                    m_packed_size += header.count;
+                }
+
+                void flush_pending() {
+                    if (!m_pending.empty()) {
+                        pack_block(m_pending.data(), m_pending.data() + m_pending.size());
+                        m_pending.clear();
+                    }
+                }
+
+                bool is_after_last(const TId id) const noexcept {
+                    if (!m_pending.empty()) {
+                        return id > m_pending.back().first;
+                    }
+                    if (!m_blocks.empty()) {
+                        const auto& header = m_blocks.back();
+                        return id > id_at(header, header.count - 1U);
+                    }
+                    return true;
+                }
+
+                void append(const TId id, const TValue value) {
+                    m_pending.emplace_back(id, value);
+                    if (m_pending.size() == block_size) {
+                        flush_pending();
+                    }
+                }
+
+                void unpack_all(std::vector<element_type>& out) const {
+                    out.reserve(out.size() + m_packed_size);
+                    for (const auto& header : m_blocks) {
+                        for (std::size_t n = 0; n < header.count; ++n) {
+                            out.emplace_back(id_at(header, n), value_at(header, n));
+                        }
+                    }
+                }
+
+                using block_iterator = typename std::vector<block_header>::const_iterator;
+
+                // Find the block that could contain the id, starting the
+                // search at the given block. Returns the end iterator if
+                // there is no such block.
+                block_iterator find_block(const block_iterator start, const TId id) const noexcept {
+                    // The first block with a first_id larger than id...
+                    const auto it = osmium::index::detail::gallop_lower_bound(start, m_blocks.cend(), id + 1, [](const block_header& header) {
+                        return header.first_id;
+                    });
+                    // ...is the one after the block we are looking for.
+                    if (it == m_blocks.cbegin()) {
+                        return m_blocks.cend();
+                    }
+                    return it - 1;
+                }
+
+                TValue find_in_block(const block_header& header, const TId id) const noexcept {
+                    std::size_t low = 0;
+                    std::size_t high = header.count;
+                    while (low < high) {
+                        const std::size_t mid = low + (high - low) / 2;
+                        if (id_at(header, mid) < id) {
+                            low = mid + 1;
+                        } else {
+                            high = mid;
+                        }
+                    }
+
+                    if (low < header.count && id_at(header, low) == id) {
+                        return value_at(header, low);
+                    }
+                    return osmium::index::empty_value<TValue>();
+                }
+
+                TValue find_pending(const TId id) const noexcept {
+                    const auto it = std::lower_bound(m_pending.cbegin(), m_pending.cend(), id, [](const element_type& element, const TId i) {
+                        return element.first < i;
+                    });
+                    if (it == m_pending.cend() || it->first != id) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return it->second;
+                }
+
+                bool in_pending(const TId id) const noexcept {
+                    return !m_pending.empty() && id >= m_pending.front().first;
+                }
+
+            public:
+
+                SparseMemCompressed() = default;
+
+                void set(const TId id, const TValue value) final {
+                    if (is_after_last(id)) {
+                        append(id, value);
+                    } else {
+                        m_unsorted.emplace_back(id, value);
+                    }
+                }
+
+                TValue get(const TId id) const final {
+                    const auto value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    if (in_pending(id)) {
+                        return find_pending(id);
+                    }
+                    const auto it = find_block(m_blocks.cbegin(), id);
+                    if (it == m_blocks.cend()) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return find_in_block(*it, id);
+                }
+
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    auto start = m_blocks.cbegin();
+                    for (std::size_t i = 0; i < count; ++i) {
+                        const TId id = ids[i];
+                        if (in_pending(id)) {
+                            values[i] = find_pending(id);
+                            continue;
+                        }
+                        if (start == m_blocks.cend() || id < start->first_id) {
+                            start = m_blocks.cbegin();
+                        }
+                        const auto it = find_block(start, id);
+                        if (it == m_blocks.cend()) {
+                            values[i] = osmium::index::empty_value<TValue>();
+                        } else {
+                            values[i] = find_in_block(*it, id);
+                            start = it;
+                        }
+                    }
+                }
+
+                std::size_t size() const noexcept final {
+                    return m_packed_size + m_pending.size() + m_unsorted.size();
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    return sizeof(uint64_t) * m_words.size() +
+                           sizeof(block_header) * m_blocks.size() +
+                           sizeof(element_type) * (m_pending.size() + m_unsorted.size());
+                }
+
+                /**
+                 * Estimate the memory a SparseMemCompressed index needs for
+                 * num_entries entries. This assumes the typical 6 bytes per
+                 * entry, the real size depends on how close together the
+                 * Ids and locations in a block are.
+                 */
+                static std::size_t estimate_memory(const std::size_t num_entries, const TId /*max_id*/) noexcept {
+                    return 6 * num_entries +
+                           sizeof(block_header) * ((num_entries + block_size - 1) / block_size);
+                }
+
+                void clear() final {
+                    m_words.clear();
+                    m_words.shrink_to_fit();
+                    m_blocks.clear();
+                    m_blocks.shrink_to_fit();
+                    m_pending.clear();
+                    m_pending.shrink_to_fit();
+                    m_unsorted.clear();
+                    m_unsorted.shrink_to_fit();
+                    m_packed_size = 0;
+                }
+
+                /**
+                 * Merge all entries that were set out of order into the
+                 * compressed blocks. Does nothing if all Ids were set in
+                 * order.
+                 */
+                void sort() final {
+                    if (m_unsorted.empty()) {
+                        return;
+                    }
+
+                    std::vector<element_type> entries;
+                    unpack_all(entries);
+                    entries.insert(entries.end(), m_pending.cbegin(), m_pending.cend());
+                    entries.insert(entries.end(), m_unsorted.cbegin(), m_unsorted.cend());
+
+                    clear();
+
+                    std::stable_sort(entries.begin(), entries.end(), [](const element_type& a, const element_type& b) {
+                        return a.first < b.first;
+                    });
+
+                    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+                        const auto next = std::next(it);
+                        if (next == entries.cend() || next->first != it->first) {
+                            append(it->first, it->second);
+                        }
+                    }
+                }
+
+                void dump_as_list(const int fd) final {
+                    sort();
+                    std::vector<element_type> entries;
+                    unpack_all(entries);
+                    entries.insert(entries.end(), m_pending.cbegin(), m_pending.cend());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(entries.data()), sizeof(element_type) * entries.size());
+                }
+
+            }; // class SparseMemCompressed
+
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, SparseMemCompressed> {
+                std::size_t operator()(const std::size_t num_entries, const TId max_id) const {
+                    return SparseMemCompressed<TId, TValue>::estimate_memory(num_entries, max_id);
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemCompressed, sparse_mem_compressed)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_SPARSE_MEM_COMPRESSED_HPP
@@ -0,0 +1,336 @@
+#ifndef OSMIUM_INDEX_MAP_SPARSE_MEM_HASH_HPP
+#define OSMIUM_INDEX_MAP_SPARSE_MEM_HASH_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/prefetch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+#define OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_HASH
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Sparse index using an open addressing hash table. Unlike the
+             * sorted vector based sparse indexes this does not need a
+             * sort() phase, so set() and get() can be called in any order,
+             * and unlike the SparseMemMap it doesn't need a heap allocation
+             * for each entry.
+             *
+             * The table is organized in groups of 16 slots. For each slot
+             * there is a control byte which is either "empty" or contains 7
+             * bits of the hash of the Id in the slot. A lookup checks all
+             * control bytes of a group at once (using SSE2 instructions if
+             * available) and only compares the Ids of the slots where
+             * those bits match. If the group has no empty slot, the next
+             * group in the probe sequence is checked. The table grows when
+             * it is 7/8 full.
+             *
+             * This needs 1 + sizeof(TId) + sizeof(TValue) bytes per slot,
+             * and there are between 1.14 and 2.3 slots per entry.
+             */
+            template <typename TId, typename TValue>
+            class SparseMemHash : public osmium::index::map::Map<TId, TValue> {
+
+                enum : std::size_t {
+                    group_size = 16,
+                    min_capacity = group_size * 4,
+
+                    // How many ids to look ahead in get_noexcept_bulk().
+                    prefetch_distance = 8
+                };
+
+                enum : uint8_t {
+                    ctrl_empty = 0x80U
+                };
+
+                std::vector<uint8_t> m_ctrl;
+                std::vector<TId> m_keys;
+                std::vector<TValue> m_values;
+
+                std::size_t m_size = 0;
+
+                // number of groups - 1
+                std::size_t m_group_mask = 0;
+
+                static uint64_t hash(const TId id) noexcept {
+                    // finalizer from MurmurHash3
+                    auto h = static_cast<uint64_t>(id);
+                    h ^= h >> 33U;
+                    h *= 0xff51afd7ed558ccdULL;
+                    h ^= h >> 33U;
+                    h *= 0xc4ceb9fe1a85ec53ULL;
+                    h ^= h >> 33U;
+                    return h;
+                }
+
+                static uint8_t h2(const uint64_t h) noexcept {
+                    return static_cast<uint8_t>(h & 0x7fU);
+                }
+
+                std::size_t h1(const uint64_t h) const noexcept {
+                    return static_cast<std::size_t>(h >> 7U) & m_group_mask;
+                }
+
+                std::size_t capacity() const noexcept {
+                    return m_ctrl.size();
+                }
+
+                // Return a bitmask with a bit set for each slot in the group
+                // with the given control byte.
+                uint32_t match(const std::size_t group, const uint8_t ctrl) const noexcept {
+                    const uint8_t* data = &m_ctrl[group * group_size];
+#if defined(__SSE2__)
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(ctrl)))));
+#else
+                    uint32_t mask = 0;
+                    for (std::size_t i = 0; i < group_size; ++i) {
+                        if (data[i] == ctrl) {
+                            mask |= 1U << i;
+                        }
+                    }
+                    return mask;
+#endif
+                }
+
+                // Find the slot with the given id. Returns capacity() if
+                // it is not found.
+                std::size_t find_slot(const TId id) const noexcept {
+                    if (m_size == 0) {
+                        return capacity();
+                    }
+                    const uint64_t h = hash(id);
+                    std::size_t group = h1(h);
+                    for (std::size_t step = 1;; ++step) {
+                        uint32_t mask = match(group, h2(h));
+                        while (mask != 0) {
+                            const std::size_t slot = group * group_size + osmium::index::detail::count_trailing_zeros(mask);
+                            if (m_keys[slot] == id) {
+                                return slot;
+                            }
+                            mask &= mask - 1;
+                        }
+                        if (match(group, ctrl_empty) != 0) {
+                            return capacity();
+                        }
+                        // triangular probing visits all groups because
+                        // the number of groups is a power of two
+                        group = (group + step) & m_group_mask;
+                    }
+                }
+
+                // Insert id which is known not to be in the table yet into
+                // a table which is known to have space for it.
+                void insert_new(const TId id, const TValue value) noexcept {
+                    const uint64_t h = hash(id);
+                    std::size_t group = h1(h);
+                    for (std::size_t step = 1;; ++step) {
+                        const uint32_t mask = match(group, ctrl_empty);
+                        if (mask != 0) {
+                            const std::size_t slot = group * group_size + osmium::index::detail::count_trailing_zeros(mask);
+                            m_ctrl[slot] = h2(h);
+                            m_keys[slot] = id;
+                            m_values[slot] = value;
+                            ++m_size;
+                            return;
+                        }
+                        group = (group + step) & m_group_mask;
+                    }
+                }
+
+                void rehash(const std::size_t new_capacity) {
+                    std::vector<uint8_t> old_ctrl(new_capacity, ctrl_empty);
+                    std::vector<TId> old_keys(new_capacity);
+                    std::vector<TValue> old_values(new_capacity);
+                    using std::swap;
+                    swap(old_ctrl, m_ctrl);
+                    swap(old_keys, m_keys);
+                    swap(old_values, m_values);
+
+                    m_size = 0;
+                    m_group_mask = new_capacity / group_size - 1;
+                    for (std::size_t slot = 0; slot < old_ctrl.size(); ++slot) {
+                        if (old_ctrl[slot] != ctrl_empty) {
+                            insert_new(old_keys[slot], old_values[slot]);
+                        }
+                    }
+                }
+
+                static std::size_t capacity_for(const std::size_t size) noexcept {
+                    std::size_t capacity = min_capacity;
+                    while (capacity / 8 * 7 < size) {
+                        capacity *= 2;
+                    }
+                    return capacity;
+                }
+
+            public:
+
+                SparseMemHash() = default;
+
+                ~SparseMemHash() noexcept override = default;
+
+                void reserve(const std::size_t size) final {
+                    const std::size_t new_capacity = capacity_for(size);
+                    if (new_capacity > capacity()) {
+                        rehash(new_capacity);
+                    }
+                }
+
+                void set(const TId id, const TValue value) final {
+                    const std::size_t slot = find_slot(id);
+                    if (slot != capacity()) {
+                        m_values[slot] = value;
+                        return;
+                    }
+                    if (m_size + 1 > capacity() / 8 * 7) {
+                        rehash(capacity_for(m_size + 1));
+                    }
+                    insert_new(id, value);
+                }
+
+                TValue get(const TId id) const final {
+                    const std::size_t slot = find_slot(id);
+                    if (slot == capacity()) {
+                        throw osmium::not_found{id};
+                    }
+                    return m_values[slot];
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const std::size_t slot = find_slot(id);
+                    if (slot == capacity()) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return m_values[slot];
+                }
+
+                void prefetch(const TId id) const noexcept final {
+                    if (m_size != 0) {
+                        const std::size_t group = h1(hash(id));
+                        osmium::prefetch(&m_ctrl[group * group_size]);
+                        osmium::prefetch(&m_keys[group * group_size]);
+                    }
+                }
+
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    const std::size_t ahead = std::min(count, static_cast<std::size_t>(prefetch_distance));
+                    for (std::size_t i = 0; i < ahead; ++i) {
+                        prefetch(ids[i]);
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (i + ahead < count) {
+                            prefetch(ids[i + ahead]);
+                        }
+                        values[i] = get_noexcept(ids[i]);
+                    }
+                }
+
+                std::size_t size() const noexcept final {
+                    return m_size;
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    return capacity() * (sizeof(uint8_t) + sizeof(TId) + sizeof(TValue));
+                }
+
+                /**
+                 * Estimate the memory a SparseMemHash index needs for
+                 * num_entries entries. This does not include the temporary
+                 * memory needed while the table grows.
+                 */
+                static std::size_t estimate_memory(const std::size_t num_entries, const TId /*max_id*/) noexcept {
+                    return capacity_for(num_entries) * (sizeof(uint8_t) + sizeof(TId) + sizeof(TValue));
+                }
+
+                void clear() final {
+                    m_ctrl.clear();
+                    m_ctrl.shrink_to_fit();
+                    m_keys.clear();
+                    m_keys.shrink_to_fit();
+                    m_values.clear();
+                    m_values.shrink_to_fit();
+                    m_size = 0;
+                    m_group_mask = 0;
+                }
+
+                void dump_as_list(const int fd) final {
+                    std::vector<std::pair<TId, TValue>> v;
+                    v.reserve(m_size);
+                    for (std::size_t slot = 0; slot < capacity(); ++slot) {
+                        if (m_ctrl[slot] != ctrl_empty) {
+                            v.emplace_back(m_keys[slot], m_values[slot]);
+                        }
+                    }
+                    std::sort(v.begin(), v.end());
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(v.data()), sizeof(std::pair<TId, TValue>) * v.size());
+                }
+
+            }; // class SparseMemHash
+
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, SparseMemHash> {
+                std::size_t operator()(const std::size_t num_entries, const TId max_id) const noexcept {
+                    return SparseMemHash<TId, TValue>::estimate_memory(num_entries, max_id);
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemHash, sparse_mem_hash)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_SPARSE_MEM_HASH_HPP
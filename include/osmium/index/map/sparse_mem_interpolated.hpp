@@ -0,0 +1,274 @@
+#ifndef OSMIUM_INDEX_MAP_SPARSE_MEM_INTERPOLATED_HPP
+#define OSMIUM_INDEX_MAP_SPARSE_MEM_INTERPOLATED_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#define OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_INTERPOLATED
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            template <typename TId, typename TValue>
+            struct sparse_mem_interpolated_parallel;
+
+        } // namespace detail
+
+        namespace map {
+
+            /**
+             * Sparse index storing Ids and values in a sorted vector like
+             * the SparseMemArray, but with an additional "learned" index
+             * to speed up lookups. When sort() is called, the sorted Ids
+             * are approximated by a piecewise linear function mapping an
+             * Id to its position in the vector. The pieces are chosen so
+             * that the predicted position is never off by more than
+             * max_error entries. A lookup then is a binary search in the
+             * small (usually cache-resident) list of pieces followed by a
+             * binary search in a window of 2 * max_error entries around
+             * the predicted position instead of a binary search over the
+             * whole vector. This saves most of the cache misses of a
+             * lookup.
+             *
+             * Because OSM Ids are assigned sequentially and the objects in
+             * an extract usually come from few ranges of Ids, few pieces
+             * are needed and the additional memory needed is negligible.
+             *
+             * You have to call sort() (or osmium::index::map::parallel_sort()
+             * from osmium/index/map_parallel.hpp) after setting the values
+             * and before reading from the index. Setting a value after that
+             * invalidates the learned index, lookups will fall back to a
+             * binary search over the whole vector until sort() is called
+             * again.
+             */
+            template <typename TId, typename TValue>
+            class SparseMemInterpolated : public osmium::index::map::Map<TId, TValue> {
+
+                friend struct osmium::index::detail::sparse_mem_interpolated_parallel<TId, TValue>;
+
+            public:
+
+                using element_type = typename std::pair<TId, TValue>;
+
+                // Largest difference between predicted and real position.
+                enum : std::size_t {
+                    max_error = 32
+                };
+
+            private:
+
+                struct segment {
+                    TId first_id;
+                    std::size_t start;
+                    double slope;
+                }; // struct segment
+
+                std::vector<element_type> m_vector;
+
+                std::vector<segment> m_segments;
+
+                static bool compare_id(const element_type& element, const TId id) noexcept {
+                    return element.first < id;
+                }
+
+                // Build segments using the "shrinking cone" algorithm: For
+                // each segment keep the range of slopes that predicts all
+                // positions so far with an error of at most max_error.
+                // Start a new segment when that range becomes empty.
+                void build_segments() {
+                    m_segments.clear();
+
+                    const std::size_t size = m_vector.size();
+                    std::size_t i = 0;
+                    while (i < size) {
+                        const TId first_id = m_vector[i].first;
+                        const std::size_t start = i;
+                        double slope_low = 0.0;
+                        double slope_high = static_cast<double>(size);
+
+                        for (++i; i < size; ++i) {
+                            const TId id = m_vector[i].first;
+                            if (id == m_vector[i - 1].first) {
+                                // Only the first of several entries with
+                                // the same Id has to be found.
+                                continue;
+                            }
+                            const auto dx = static_cast<double>(id - first_id);
+                            const auto dy = static_cast<double>(i - start);
+                            const double low = std::max(slope_low, (dy - max_error) / dx);
+                            const double high = std::min(slope_high, (dy + max_error) / dx);
+                            if (low > high) {
+                                break;
+                            }
+                            slope_low = low;
+                            slope_high = high;
+                        }
+
+                        m_segments.push_back(segment{first_id, start, (slope_low + slope_high) / 2});
+                    }
+                }
+
+                typename std::vector<element_type>::const_iterator find_id(const TId id) const noexcept {
+                    if (m_segments.empty()) {
+                        return std::lower_bound(m_vector.cbegin(), m_vector.cend(), id, compare_id);
+                    }
+
+                    auto seg = std::upper_bound(m_segments.cbegin(), m_segments.cend(), id, [](const TId i, const segment& s) {
+                        return i < s.first_id;
+                    });
+                    if (seg == m_segments.cbegin()) {
+                        return m_vector.cend();
+                    }
+                    --seg;
+
+                    const std::size_t seg_end = (seg + 1 == m_segments.cend()) ? m_vector.size() : (seg + 1)->start;
+                    const double offset = std::min(seg->slope * static_cast<double>(id - seg->first_id),
+                                                   static_cast<double>(seg_end - seg->start));
+                    const std::size_t predicted = seg->start + static_cast<std::size_t>(offset);
+
+                    // Allow for some rounding error on top of max_error.
+                    const std::size_t low = predicted > seg->start + max_error + 1 ? predicted - max_error - 1 : seg->start;
+                    const std::size_t high = std::min(predicted + max_error + 2, seg_end);
+                    if (low >= high) {
+                        return m_vector.cend();
+                    }
+
+                    const auto it = std::lower_bound(m_vector.cbegin() + static_cast<std::ptrdiff_t>(low),
+                                                     m_vector.cbegin() + static_cast<std::ptrdiff_t>(high),
+                                                     id, compare_id);
+                    return it;
+                }
+
+            public:
+
+                SparseMemInterpolated() = default;
+
+                ~SparseMemInterpolated() noexcept override = default;
+
+                void reserve(const std::size_t size) final {
+                    m_vector.reserve(size);
+                }
+
+                void set(const TId id, const TValue value) final {
+                    m_segments.clear();
+                    m_vector.emplace_back(id, value);
+                }
+
+                TValue get(const TId id) const final {
+                    const auto it = find_id(id);
+                    if (it == m_vector.cend() || it->first != id) {
+                        throw osmium::not_found{id};
+                    }
+                    return it->second;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const auto it = find_id(id);
+                    if (it == m_vector.cend() || it->first != id) {
+                        return osmium::index::empty_value<TValue>();
+                    }
+                    return it->second;
+                }
+
+                std::size_t size() const final {
+                    return m_vector.size();
+                }
+
+                /**
+                 * The number of pieces in the piecewise linear function.
+                 */
+                std::size_t num_segments() const noexcept {
+                    return m_segments.size();
+                }
+
+                std::size_t used_memory() const final {
+                    return sizeof(element_type) * m_vector.size() + sizeof(segment) * m_segments.size();
+                }
+
+                /**
+                 * Estimate the memory a SparseMemInterpolated index needs for
+                 * num_entries entries. The number of segments depends on the
+                 * distribution of the Ids and is not included.
+                 */
+                static std::size_t estimate_memory(const std::size_t num_entries, const TId /*max_id*/) noexcept {
+                    return sizeof(element_type) * num_entries;
+                }
+
+                void clear() final {
+                    m_vector.clear();
+                    m_vector.shrink_to_fit();
+                    m_segments.clear();
+                    m_segments.shrink_to_fit();
+                }
+
+                void sort() final {
+                    std::sort(m_vector.begin(), m_vector.end());
+                    build_segments();
+                }
+
+                void dump_as_list(const int fd) final {
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(m_vector.data()), sizeof(element_type) * m_vector.size());
+                }
+
+            }; // class SparseMemInterpolated
+
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, SparseMemInterpolated> {
+                std::size_t operator()(const std::size_t num_entries, const TId max_id) const {
+                    return SparseMemInterpolated<TId, TValue>::estimate_memory(num_entries, max_id);
+                }
+            };
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#ifdef OSMIUM_WANT_NODE_LOCATION_MAPS
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemInterpolated, sparse_mem_interpolated)
+#endif
+
+#endif // OSMIUM_INDEX_MAP_SPARSE_MEM_INTERPOLATED_HPP
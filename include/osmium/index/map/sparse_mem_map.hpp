@@ -100,6 +100,14 @@ namespace osmium {
                     return element_size * m_elements.size();
                 }
 
+                /**
+                 * Estimate the memory a SparseMemMap index needs for
+                 * num_entries entries.
+                 */
+                static std::size_t estimate_memory(const std::size_t num_entries, const TId /*max_id*/) noexcept {
+                    return element_size * num_entries;
+                }
+
                 void clear() final {
                     m_elements.clear();
                 }
@@ -114,6 +122,13 @@ namespace osmium {
 
             }; // class SparseMemMap
 
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, SparseMemMap> {
+                std::size_t operator()(const std::size_t num_entries, const TId max_id) const {
+                    return SparseMemMap<TId, TValue>::estimate_memory(num_entries, max_id);
+                }
+            };
+
         } // namespace map
 
     } // namespace index
@@ -38,6 +38,8 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/index/detail/mmap_vector_anon.hpp>
 #include <osmium/index/detail/vector_map.hpp>
 
+#include <cstddef>
+
 #define OSMIUM_HAS_INDEX_MAP_SPARSE_MMAP_ARRAY
 
 namespace osmium {
@@ -49,6 +51,14 @@ namespace osmium {
             template <typename TId, typename TValue>
             using SparseMmapArray = VectorBasedSparseMap<TId, TValue, osmium::detail::mmap_vector_anon>;
 
+            // Sparse arrays need space for an (id, value) pair per entry.
+            template <typename TId, typename TValue>
+            struct estimate_memory<TId, TValue, SparseMmapArray> {
+                std::size_t operator()(const std::size_t num_entries, const TId /*max_id*/) const noexcept {
+                    return num_entries * sizeof(typename SparseMmapArray<TId, TValue>::element_type);
+                }
+            };
+
         } // namespace map
 
     } // namespace index
@@ -0,0 +1,280 @@
+#ifndef OSMIUM_INDEX_MAP_UPDATABLE_LOCATION_CACHE_HPP
+#define OSMIUM_INDEX_MAP_UPDATABLE_LOCATION_CACHE_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/index.hpp>
+#include <osmium/index/map.hpp>
+#include <osmium/index/map/location_cache.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/timestamp.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace map {
+
+            /**
+             * Location cache that can be updated, for instance from
+             * replication diffs. It consists of a read-only base
+             * LocationCache file and an in-memory overlay with all changes
+             * since the base file was written. Changed and new entries are
+             * stored in the overlay, removed entries are stored in the
+             * overlay as empty values. Lookups check the overlay first and
+             * then the base file.
+             *
+             * Call compact() from time to time to merge the overlay into a
+             * new base file. This writes the new file sequentially without
+             * sorting anything, so it is much faster than re-creating the
+             * cache.
+             */
+            template <typename TId, typename TValue>
+            class UpdatableLocationCache : public osmium::index::map::Map<TId, TValue> {
+
+                using base_type = LocationCache<TId, TValue>;
+                using overlay_type = std::map<TId, TValue>;
+                using element_type = std::pair<TId, TValue>;
+
+                // Number of entries written at once when compacting.
+                enum : std::size_t {
+                    write_buffer_size = 1024UL * 1024UL
+                };
+
+                base_type m_base;
+                overlay_type m_overlay;
+
+                template <typename T>
+                static void flush(const int fd, std::vector<T>& buffer) {
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(buffer.data()), sizeof(T) * buffer.size());
+                    buffer.clear();
+                }
+
+                template <typename T>
+                static void append(const int fd, std::vector<T>& buffer, const T& value) {
+                    buffer.push_back(value);
+                    if (buffer.size() >= write_buffer_size) {
+                        flush(fd, buffer);
+                    }
+                }
+
+                void write_dense(const int fd) const {
+                    std::size_t count = m_base.size();
+                    if (!m_overlay.empty()) {
+                        count = std::max(count, static_cast<std::size_t>(m_overlay.rbegin()->first) + 1);
+                    }
+
+                    std::vector<TValue> buffer;
+                    buffer.reserve(write_buffer_size);
+                    auto it = m_overlay.cbegin();
+                    for (std::size_t id = 0; id < count; ++id) {
+                        if (it != m_overlay.cend() && it->first == id) {
+                            append(fd, buffer, it->second);
+                            ++it;
+                        } else {
+                            append(fd, buffer, m_base.get_noexcept(static_cast<TId>(id)));
+                        }
+                    }
+                    flush(fd, buffer);
+                }
+
+                void write_sparse(const int fd) const {
+                    std::vector<element_type> buffer;
+                    buffer.reserve(write_buffer_size);
+                    auto it = m_overlay.cbegin();
+
+                    const auto add_overlay_element = [&]() {
+                        if (it->second != osmium::index::empty_value<TValue>()) {
+                            append(fd, buffer, element_type{it->first, it->second});
+                        }
+                        ++it;
+                    };
+
+                    m_base.for_each([&](const TId id, const TValue& value) {
+                        while (it != m_overlay.cend() && it->first < id) {
+                            add_overlay_element();
+                        }
+                        if (it != m_overlay.cend() && it->first == id) {
+                            add_overlay_element();
+                        } else {
+                            append(fd, buffer, element_type{id, value});
+                        }
+                    });
+
+                    while (it != m_overlay.cend()) {
+                        add_overlay_element();
+                    }
+                    flush(fd, buffer);
+                }
+
+            public:
+
+                /**
+                 * Open location cache from a file descriptor. The file
+                 * descriptor can be closed after this.
+                 *
+                 * @throws location_cache_error If the file is not a valid
+                 *         location cache file for this index type.
+                 */
+                explicit UpdatableLocationCache(const int fd) :
+                    m_base(fd) {
+                }
+
+                /**
+                 * Open location cache file with the given name.
+                 *
+                 * @throws std::system_error If the file can not be opened.
+                 * @throws location_cache_error If the file is not a valid
+                 *         location cache file for this index type.
+                 */
+                explicit UpdatableLocationCache(const std::string& filename) :
+                    m_base(filename) {
+                }
+
+                /// The read-only base location cache.
+                const base_type& base() const noexcept {
+                    return m_base;
+                }
+
+                /// The number of changes not yet merged into the base file.
+                std::size_t overlay_size() const noexcept {
+                    return m_overlay.size();
+                }
+
+                /// Add or change an entry.
+                void set(const TId id, const TValue value) final {
+                    m_overlay[id] = value;
+                }
+
+                /// Remove an entry.
+                void remove(const TId id) {
+                    m_overlay[id] = osmium::index::empty_value<TValue>();
+                }
+
+                TValue get(const TId id) const final {
+                    const TValue value = get_noexcept(id);
+                    if (value == osmium::index::empty_value<TValue>()) {
+                        throw osmium::not_found{id};
+                    }
+                    return value;
+                }
+
+                TValue get_noexcept(const TId id) const noexcept final {
+                    const auto it = m_overlay.find(id);
+                    if (it != m_overlay.end()) {
+                        return it->second;
+                    }
+                    return m_base.get_noexcept(id);
+                }
+
+                void get_noexcept_bulk(const TId* ids, const std::size_t count, TValue* values) const noexcept final {
+                    m_base.get_noexcept_bulk(ids, count, values);
+                    if (m_overlay.empty()) {
+                        return;
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        const auto it = m_overlay.find(ids[i]);
+                        if (it != m_overlay.end()) {
+                            values[i] = it->second;
+                        }
+                    }
+                }
+
+                /**
+                 * The number of entries in the base file plus the number of
+                 * changes in the overlay.
+                 */
+                std::size_t size() const noexcept final {
+                    return m_base.size() + m_overlay.size();
+                }
+
+                std::size_t used_memory() const noexcept final {
+                    // unused memory is ignored
+                    return m_base.used_memory() + m_overlay.size() * (sizeof(element_type) + 4 * sizeof(void*));
+                }
+
+                void clear() final {
+                    m_base.clear();
+                    m_overlay.clear();
+                }
+
+                /**
+                 * Merge the base file and the overlay into a new location
+                 * cache file of the same type as the base file. Afterwards
+                 * the new file is used as base file and the overlay is
+                 * empty.
+                 *
+                 * The new file must not be the same as the current base
+                 * file. To replace the base file, write to a new file and
+                 * rename it afterwards.
+                 *
+                 * @param fd File descriptor of the new file. Must be opened
+                 *           for reading and writing. Existing content will
+                 *           be overwritten.
+                 * @param timestamp Timestamp of the data after applying all
+                 *                  changes.
+                 * @returns The header written to the new file.
+                 */
+                location_cache_header compact(const int fd, const osmium::Timestamp timestamp) {
+                    location_cache_header header = osmium::index::detail::start_location_cache<TId, TValue>(fd, m_base.type(), timestamp);
+
+                    if (m_base.type() == location_cache_type::dense) {
+                        write_dense(fd);
+                    } else {
+                        write_sparse(fd);
+                    }
+
+                    osmium::index::detail::finish_location_cache<TId, TValue>(fd, header);
+
+                    m_base = base_type{fd};
+                    m_overlay.clear();
+
+                    return header;
+                }
+
+            }; // class UpdatableLocationCache
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MAP_UPDATABLE_LOCATION_CACHE_HPP
@@ -0,0 +1,130 @@
+#ifndef OSMIUM_INDEX_MAP_PARALLEL_HPP
+#define OSMIUM_INDEX_MAP_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/parallel_sort.hpp>
+#include <osmium/index/detail/vector_map.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/index/map/sparse_mem_interpolated.hpp>
+#include <osmium/thread/pool.hpp>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            template <typename TId, typename TValue>
+            struct flex_mem_parallel {
+
+                using map_type = osmium::index::map::FlexMem<TId, TValue>;
+                using entry_type = typename map_type::entry;
+
+                static void sort(map_type& map, osmium::thread::Pool& pool) {
+                    osmium::index::detail::parallel_sort(map.m_sparse_entries.begin(), map.m_sparse_entries.end(), [](const entry_type& e) {
+                        return e.id;
+                    }, pool);
+                }
+
+            }; // struct flex_mem_parallel
+
+            template <typename TId, typename TValue>
+            struct sparse_mem_interpolated_parallel {
+
+                using map_type = osmium::index::map::SparseMemInterpolated<TId, TValue>;
+                using element_type = typename map_type::element_type;
+
+                static void sort(map_type& map, osmium::thread::Pool& pool) {
+                    osmium::index::detail::parallel_sort(map.m_vector.begin(), map.m_vector.end(), [](const element_type& element) {
+                        return element.first;
+                    }, pool);
+                    map.build_segments();
+                }
+
+            }; // struct sparse_mem_interpolated_parallel
+
+        } // namespace detail
+
+        namespace map {
+
+            /**
+             * Sort the map using the threads in the pool. Does the same as
+             * calling sort() on the map, but the entries are partitioned
+             * by the highest bits of the Id and the partitions are sorted
+             * in parallel.
+             *
+             * This works on SparseMemArray, SparseMmapArray, and
+             * SparseFileArray.
+             *
+             * Do not call this from a task running in the same pool.
+             */
+            template <typename TId, typename TValue, template <typename...> class TVector>
+            void parallel_sort(VectorBasedSparseMap<TId, TValue, TVector>& map, osmium::thread::Pool& pool) {
+                using element_type = typename VectorBasedSparseMap<TId, TValue, TVector>::element_type;
+                osmium::index::detail::parallel_sort(map.begin(), map.end(), [](const element_type& element) {
+                    return element.first;
+                }, pool);
+            }
+
+            /**
+             * Sort the FlexMem map using the threads in the pool. Does the
+             * same as FlexMem::sort(). In dense mode there is nothing to
+             * sort.
+             *
+             * Do not call this from a task running in the same pool.
+             */
+            template <typename TId, typename TValue>
+            void parallel_sort(FlexMem<TId, TValue>& map, osmium::thread::Pool& pool) {
+                osmium::index::detail::flex_mem_parallel<TId, TValue>::sort(map, pool);
+            }
+
+            /**
+             * Sort the SparseMemInterpolated map using the threads in the
+             * pool and build the learned index. Does the same as
+             * SparseMemInterpolated::sort().
+             *
+             * Do not call this from a task running in the same pool.
+             */
+            template <typename TId, typename TValue>
+            void parallel_sort(SparseMemInterpolated<TId, TValue>& map, osmium::thread::Pool& pool) {
+                osmium::index::detail::sparse_mem_interpolated_parallel<TId, TValue>::sort(map, pool);
+            }
+
+        } // namespace map
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MAP_PARALLEL_HPP
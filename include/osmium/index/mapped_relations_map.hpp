@@ -0,0 +1,394 @@
+#ifndef OSMIUM_INDEX_MAPPED_RELATIONS_MAP_HPP
+#define OSMIUM_INDEX_MAPPED_RELATIONS_MAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/compatibility.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+#include <osmium/util/prefetch.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a relations map file can not be read or
+     * written.
+     */
+    struct OSMIUM_EXPORT relations_map_error : public std::runtime_error {
+
+        explicit relations_map_error(const char* message) :
+            std::runtime_error(message) {
+        }
+
+        explicit relations_map_error(const std::string& message) :
+            std::runtime_error(message) {
+        }
+
+    }; // struct relations_map_error
+
+    namespace index {
+
+        /**
+         * Header of a relations map file. The header is followed by
+         * num_keys + 1 tree nodes (the first one is unused) and the
+         * value lists. All numbers are stored in the native byte order.
+         */
+        struct relations_map_header {
+
+            enum : uint32_t {
+                current_version = 1,
+                byte_order_mark = 0x01020304
+            };
+
+            /// Always "OSMRELMP"
+            char magic[8];
+
+            /// Version of the file format
+            uint32_t version;
+
+            /// Used to detect files written on a machine with another byte order
+            uint32_t byte_order;
+
+            /// Number of distinct keys
+            uint64_t num_keys;
+
+            /// Number of (key, value) pairs
+            uint64_t num_entries;
+
+        }; // struct relations_map_header
+
+        static_assert(sizeof(relations_map_header) == 32, "relations_map_header must be 32 bytes");
+
+        namespace detail {
+
+            constexpr const char relations_map_magic[] = "OSMRELMP";
+
+            struct relations_map_node {
+
+                /// The key (relation id)
+                uint32_t key;
+
+                /// Offset of the value list in the values array. The
+                /// list starts with the number of values.
+                uint32_t offset;
+
+            }; // struct relations_map_node
+
+        } // namespace detail
+
+        /**
+         * Read-only version of the RelationsMapIndex which can be stored
+         * in a file and memory mapped from there. This makes opening the
+         * index instantaneous and several processes can share the same
+         * memory.
+         *
+         * The distinct keys are stored in a search tree in Eytzinger
+         * (breadth-first) order, each with the offset of its list of
+         * values. A lookup walks down the tree from the root. The first
+         * few levels of the tree will always be in the CPU cache, and the
+         * nodes needed later can be prefetched, so this is faster than a
+         * binary search over a sorted array.
+         *
+         * @code
+         * RelationsMapStash stash;
+         * ...
+         * const auto index = stash.build_member_to_parent_index();
+         * const MappedRelationsMapIndex mapped_index{index};
+         * mapped_index.write(fd);
+         * ...
+         * const MappedRelationsMapIndex index_from_file{"relations.idx"};
+         * index_from_file.for_each(member_id, [](osmium::unsigned_object_id_type parent_id) {
+         *   ...
+         * });
+         * @endcode
+         */
+        class MappedRelationsMapIndex {
+
+            osmium::MemoryMapping m_mapping;
+            relations_map_header m_header;
+
+            static osmium::MemoryMapping map_file(const int fd) {
+                const std::size_t size = osmium::file_size(fd);
+                if (size < sizeof(relations_map_header)) {
+                    throw relations_map_error{"relations map file too small"};
+                }
+                return osmium::MemoryMapping{size, osmium::MemoryMapping::mapping_mode::readonly, fd};
+            }
+
+            static osmium::MemoryMapping open_and_map_file(const std::string& filename) {
+                const int fd = osmium::io::detail::open_for_reading(filename);
+                try {
+                    osmium::MemoryMapping mapping{map_file(fd)};
+                    osmium::io::detail::reliable_close(fd);
+                    return mapping;
+                } catch (...) {
+                    osmium::io::detail::reliable_close(fd);
+                    throw;
+                }
+            }
+
+            static std::size_t file_size(const relations_map_header& header) noexcept {
+                return sizeof(relations_map_header) +
+                       (header.num_keys + 1) * sizeof(detail::relations_map_node) +
+                       (header.num_keys + header.num_entries) * sizeof(uint32_t);
+            }
+
+            static relations_map_header make_header(const RelationsMapIndex& index) {
+                relations_map_header header{};
+                std::memcpy(header.magic, detail::relations_map_magic, sizeof(header.magic));
+                header.version = relations_map_header::current_version;
+                header.byte_order = relations_map_header::byte_order_mark;
+                header.num_entries = index.size();
+
+                const auto& map = index.m_map;
+                for (auto it = map.begin(); it != map.end(); ++it) {
+                    if (it == map.begin() || it->key != std::prev(it)->key) {
+                        ++header.num_keys;
+                    }
+                }
+
+                if (header.num_keys + header.num_entries > std::numeric_limits<uint32_t>::max()) {
+                    throw relations_map_error{"relations map too large"};
+                }
+
+                return header;
+            }
+
+            const detail::relations_map_node* nodes() const noexcept {
+                return reinterpret_cast<const detail::relations_map_node*>(m_mapping.get_addr<const char>() + sizeof(relations_map_header));
+            }
+
+            const uint32_t* values() const noexcept {
+                return reinterpret_cast<const uint32_t*>(nodes() + m_header.num_keys + 1);
+            }
+
+            void check_header() const {
+                if (std::memcmp(m_header.magic, detail::relations_map_magic, sizeof(m_header.magic)) != 0) {
+                    throw relations_map_error{"not a relations map file"};
+                }
+                if (m_header.version != relations_map_header::current_version) {
+                    throw relations_map_error{"unsupported relations map file version " + std::to_string(m_header.version)};
+                }
+                if (m_header.byte_order != relations_map_header::byte_order_mark) {
+                    throw relations_map_error{"relations map file was written on a machine with different byte order"};
+                }
+                if (m_mapping.size() != file_size(m_header)) {
+                    throw relations_map_error{"relations map file has wrong size (truncated?)"};
+                }
+            }
+
+            explicit MappedRelationsMapIndex(osmium::MemoryMapping&& mapping) :
+                m_mapping(std::move(mapping)),
+                m_header() {
+                std::memcpy(&m_header, m_mapping.get_addr<const char>(), sizeof(relations_map_header));
+                check_header();
+            }
+
+            // Fill the tree nodes in Eytzinger order by doing an in-order
+            // traversal of the implicit tree.
+            static void fill_tree(detail::relations_map_node* tree, const std::size_t size,
+                                  const std::vector<detail::relations_map_node>& sorted,
+                                  std::size_t& n, const std::size_t k) noexcept {
+                if (k <= size) {
+                    fill_tree(tree, size, sorted, n, 2 * k);
+                    tree[k] = sorted[n++];
+                    fill_tree(tree, size, sorted, n, 2 * k + 1);
+                }
+            }
+
+            MappedRelationsMapIndex(const RelationsMapIndex& index, const relations_map_header& header) :
+                m_mapping(file_size(header), osmium::MemoryMapping::mapping_mode::write_private),
+                m_header(header) {
+                char* out = m_mapping.get_addr<char>();
+                std::memcpy(out, &m_header, sizeof(relations_map_header));
+
+                std::vector<detail::relations_map_node> sorted;
+                sorted.reserve(m_header.num_keys);
+
+                auto* const values = reinterpret_cast<uint32_t*>(out + sizeof(relations_map_header) + (m_header.num_keys + 1) * sizeof(detail::relations_map_node));
+                uint32_t offset = 0;
+                const auto& map = index.m_map;
+                for (auto it = map.begin(); it != map.end();) {
+                    const auto key = it->key;
+                    sorted.push_back(detail::relations_map_node{key, offset});
+                    uint32_t& count = values[offset++];
+                    count = 0;
+                    for (; it != map.end() && it->key == key; ++it) {
+                        values[offset++] = it->value;
+                        ++count;
+                    }
+                }
+
+                auto* const tree = reinterpret_cast<detail::relations_map_node*>(out + sizeof(relations_map_header));
+                tree[0] = detail::relations_map_node{0, 0};
+                std::size_t n = 0;
+                fill_tree(tree, sorted.size(), sorted, n, 1);
+            }
+
+            // Return the position of the node with the given key in the
+            // tree or 0 if it is not there.
+            std::size_t find(const osmium::unsigned_object_id_type key) const noexcept {
+                const auto* const tree = nodes();
+                const std::size_t size = m_header.num_keys;
+
+                std::size_t k = 1;
+                while (k <= size) {
+                    osmium::prefetch(tree + 8 * k);
+                    k = 2 * k + (tree[k].key < key ? 1 : 0);
+                }
+
+                // Go back up the tree to the last node where we went left,
+                // this is the first node with a key not less than the one
+                // we are looking for.
+                k >>= detail::count_trailing_zeros(~static_cast<uint64_t>(k)) + 1;
+
+                if (k == 0 || tree[k].key != key) {
+                    return 0;
+                }
+                return k;
+            }
+
+        public:
+
+            /**
+             * Create index in memory from a RelationsMapIndex. Use write()
+             * to write it to a file.
+             *
+             * @throws relations_map_error If the index is too large.
+             */
+            explicit MappedRelationsMapIndex(const RelationsMapIndex& index) :
+                MappedRelationsMapIndex(index, make_header(index)) {
+            }
+
+            /**
+             * Open an index file from a file descriptor. The file
+             * descriptor can be closed after this, the index will stay
+             * usable.
+             *
+             * @throws relations_map_error If the file is not a valid
+             *         relations map file.
+             */
+            explicit MappedRelationsMapIndex(const int fd) :
+                MappedRelationsMapIndex(map_file(fd)) {
+            }
+
+            /**
+             * Open the index file with the given name.
+             *
+             * @throws std::system_error If the file can not be opened.
+             * @throws relations_map_error If the file is not a valid
+             *         relations map file.
+             */
+            explicit MappedRelationsMapIndex(const std::string& filename) :
+                MappedRelationsMapIndex(open_and_map_file(filename)) {
+            }
+
+            /**
+             * Find the given relation id in the index and call the given
+             * function with all related relation ids.
+             *
+             * Complexity: Logarithmic in the number of distinct keys in
+             *             the index.
+             */
+            template <typename TFunc>
+            void for_each(const osmium::unsigned_object_id_type id, TFunc&& func) const {
+                if (id > std::numeric_limits<uint32_t>::max()) {
+                    return;
+                }
+                const std::size_t k = find(id);
+                if (k == 0) {
+                    return;
+                }
+                const uint32_t* value = values() + nodes()[k].offset;
+                const uint32_t count = *value++;
+                for (uint32_t i = 0; i < count; ++i) {
+                    func(static_cast<osmium::unsigned_object_id_type>(value[i]));
+                }
+            }
+
+            /**
+             * Is this index empty?
+             *
+             * Complexity: Constant.
+             */
+            bool empty() const noexcept {
+                return m_header.num_entries == 0;
+            }
+
+            /**
+             * How many entries are in this index?
+             *
+             * Complexity: Constant.
+             */
+            std::size_t size() const noexcept {
+                return static_cast<std::size_t>(m_header.num_entries);
+            }
+
+            /**
+             * The memory used by this index in bytes. This is also the
+             * size of the file written by write().
+             */
+            std::size_t used_memory() const noexcept {
+                return file_size(m_header);
+            }
+
+            /**
+             * Write the index to the file descriptor.
+             *
+             * @throws std::system_error If the file could not be written.
+             */
+            void write(const int fd) const {
+                osmium::io::detail::reliable_write(fd, m_mapping.get_addr<const char>(), file_size(m_header));
+            }
+
+        }; // class MappedRelationsMapIndex
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MAPPED_RELATIONS_MAP_HPP
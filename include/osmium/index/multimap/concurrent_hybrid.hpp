@@ -0,0 +1,467 @@
+#ifndef OSMIUM_INDEX_MULTIMAP_CONCURRENT_HYBRID_HPP
+#define OSMIUM_INDEX_MULTIMAP_CONCURRENT_HYBRID_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/multimap.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace multimap {
+
+            /**
+             * A multimap similar to the Hybrid multimap that can be used
+             * from several threads at the same time. Entries can be added
+             * and removed while other threads query the multimap and while
+             * the new entries are merged into the main part.
+             *
+             * Like in the Hybrid multimap there is a large sorted main part
+             * and a small "extra" part for new entries and removals. The
+             * main part is never changed once it is created. When consolidating,
+             * the extra part is frozen, a new main part is created from
+             * the old main part and the frozen extra part, and then the new
+             * main part replaces the old one (copy-on-write). Readers hold
+             * a reference to the main part they are looking at, so they
+             * never have to wait for a consolidation to finish. Only very
+             * short critical sections are needed for swapping in the new
+             * parts and for accessing the extra part.
+             *
+             * Consolidation can be done explicitly with consolidate(),
+             * which can be called at any time from any thread, or
+             * automatically in the background on a thread pool whenever
+             * the extra part grows beyond a configurable size.
+             *
+             * Note that a consolidation needs memory for the old and the
+             * new main part at the same time.
+             */
+            template <typename TId, typename TValue>
+            class ConcurrentHybrid : public Multimap<TId, TValue> {
+
+            public:
+
+                using element_type = std::pair<TId, TValue>;
+
+                enum : std::size_t {
+                    default_consolidate_size = 1024UL * 1024UL
+                };
+
+            private:
+
+                struct operation {
+                    TValue value;
+                    bool removed;
+                }; // struct operation
+
+                using main_type  = std::vector<element_type>;
+                using extra_type = std::multimap<TId, operation>;
+
+                // Protects all members except m_pool and m_consolidate_size.
+                mutable std::mutex m_mutex;
+
+                // Only one consolidation can run at a time.
+                std::mutex m_consolidate_mutex;
+
+                // Sorted main part. Never changed, only replaced.
+                std::shared_ptr<const main_type> m_main;
+
+                // Extra part currently being merged into the main part.
+                std::shared_ptr<const extra_type> m_merging;
+
+                // New entries and removals.
+                extra_type m_extra;
+
+                // Pool for background consolidation (or nullptr).
+                osmium::thread::Pool* m_pool = nullptr;
+
+                std::size_t m_consolidate_size = default_consolidate_size;
+
+                // Result of the last background consolidation.
+                std::future<void> m_background;
+
+                // First error of a background consolidation not reported
+                // yet.
+                std::exception_ptr m_background_error;
+
+                bool m_background_pending = false;
+
+                template <typename TIter>
+                static void apply(std::vector<TValue>& values, TIter begin, TIter end) {
+                    for (; begin != end; ++begin) {
+                        const operation& op = begin->second;
+                        if (op.removed) {
+                            const auto it = std::find(values.begin(), values.end(), op.value);
+                            if (it != values.end()) {
+                                values.erase(it);
+                            }
+                        } else {
+                            values.push_back(op.value);
+                        }
+                    }
+                }
+
+                static main_type merge(const main_type& main, const extra_type& extra) {
+                    main_type result;
+                    result.reserve(main.size() + extra.size());
+
+                    auto it = main.cbegin();
+                    std::vector<TValue> values;
+                    for (auto eit = extra.cbegin(); eit != extra.cend();) {
+                        const TId id = eit->first;
+                        const auto eend = extra.upper_bound(id);
+
+                        for (; it != main.cend() && it->first < id; ++it) {
+                            result.push_back(*it);
+                        }
+
+                        values.clear();
+                        for (; it != main.cend() && it->first == id; ++it) {
+                            values.push_back(it->second);
+                        }
+                        apply(values, eit, eend);
+                        std::sort(values.begin(), values.end());
+                        for (const auto& value : values) {
+                            result.emplace_back(id, value);
+                        }
+
+                        eit = eend;
+                    }
+                    result.insert(result.end(), it, main.cend());
+
+                    return result;
+                }
+
+                void add_operation(const TId id, const TValue value, const bool removed) {
+                    bool start_background = false;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        m_extra.emplace(id, operation{value, removed});
+                        if (m_pool && !m_background_pending && m_extra.size() >= m_consolidate_size) {
+                            m_background_pending = true;
+                            start_background = true;
+                        }
+                    }
+
+                    if (start_background) {
+                        auto future = m_pool->submit([this]() {
+                            std::exception_ptr error;
+                            try {
+                                merge_extra();
+                            } catch (...) {
+                                error = std::current_exception();
+                            }
+                            background_done(error);
+                        });
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        m_background = std::move(future);
+                    }
+                }
+
+                void background_done(const std::exception_ptr& error) {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    if (error && !m_background_error) {
+                        m_background_error = error;
+                    }
+                    m_background_pending = false;
+                }
+
+                void wait_for_background() noexcept {
+                    std::future<void> future;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        future = std::move(m_background);
+                    }
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                    // Make sure the background task has released the mutex.
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                }
+
+                // Wait for the background consolidation to finish. If a
+                // background consolidation failed, the exception is
+                // rethrown.
+                void finish_background() {
+                    std::future<void> future;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        future = std::move(m_background);
+                    }
+                    if (future.valid()) {
+                        future.get();
+                    }
+                    std::exception_ptr error;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        std::swap(error, m_background_error);
+                    }
+                    if (error) {
+                        std::rethrow_exception(error);
+                    }
+                }
+
+                void merge_extra() {
+                    std::lock_guard<std::mutex> consolidate_lock{m_consolidate_mutex};
+
+                    std::shared_ptr<const main_type> main;
+                    std::shared_ptr<const extra_type> merging;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        if (m_extra.empty()) {
+                            return;
+                        }
+                        m_merging = std::make_shared<const extra_type>(std::move(m_extra));
+                        m_extra.clear();
+                        main = m_main;
+                        merging = m_merging;
+                    }
+
+                    try {
+                        auto new_main = std::make_shared<const main_type>(merge(*main, *merging));
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        m_main = std::move(new_main);
+                        m_merging.reset();
+                    } catch (...) {
+                        // Put the entries back, they must come before any
+                        // added in the meantime.
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        extra_type extra{*m_merging};
+                        for (const auto& element : m_extra) {
+                            extra.insert(extra.end(), element);
+                        }
+                        m_extra.swap(extra);
+                        m_merging.reset();
+                        throw;
+                    }
+                }
+
+            public:
+
+                /**
+                 * Create multimap. Consolidation must be triggered
+                 * explicitly by calling consolidate().
+                 */
+                ConcurrentHybrid() :
+                    m_main(std::make_shared<const main_type>()) {
+                }
+
+                /**
+                 * Create multimap which consolidates automatically in the
+                 * background on the given thread pool whenever more than
+                 * consolidate_size entries and removals are in the extra
+                 * part.
+                 */
+                explicit ConcurrentHybrid(osmium::thread::Pool& pool, const std::size_t consolidate_size = default_consolidate_size) :
+                    m_main(std::make_shared<const main_type>()),
+                    m_pool(&pool),
+                    m_consolidate_size(consolidate_size) {
+                }
+
+                ConcurrentHybrid(const ConcurrentHybrid&) = delete;
+                ConcurrentHybrid& operator=(const ConcurrentHybrid&) = delete;
+
+                ConcurrentHybrid(ConcurrentHybrid&&) = delete;
+                ConcurrentHybrid& operator=(ConcurrentHybrid&&) = delete;
+
+                ~ConcurrentHybrid() noexcept override {
+                    wait_for_background();
+                }
+
+                /**
+                 * The number of entries in the multimap. This is only
+                 * an approximation, because removals that have not been
+                 * consolidated yet are counted as entries.
+                 */
+                std::size_t size() const final {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    return m_main->size() + (m_merging ? m_merging->size() : 0) + m_extra.size();
+                }
+
+                std::size_t used_memory() const final {
+                    // Approximate size of a node in a std::multimap.
+                    const std::size_t node_size = sizeof(typename extra_type::value_type) + 4 * sizeof(void*);
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    return m_main->capacity() * sizeof(element_type) +
+                           ((m_merging ? m_merging->size() : 0) + m_extra.size()) * node_size;
+                }
+
+                /**
+                 * The number of entries and removals not merged into the
+                 * main part yet.
+                 */
+                std::size_t extra_size() const {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    return (m_merging ? m_merging->size() : 0) + m_extra.size();
+                }
+
+                /**
+                 * Add an entry. Can be called from any thread.
+                 *
+                 * Errors of background consolidations are not reported
+                 * here but by the next call to consolidate() or sort(), so
+                 * if this throws, the entry was not added.
+                 */
+                void set(const TId id, const TValue value) final {
+                    add_operation(id, value, false);
+                }
+
+                /**
+                 * Remove one entry with the given id and value if there is
+                 * one. Can be called from any thread. Like set() this
+                 * doesn't report errors of background consolidations.
+                 */
+                void remove(const TId id, const TValue value) {
+                    add_operation(id, value, true);
+                }
+
+                /**
+                 * Get all values for the given id. The values in the main
+                 * part come first in sorted order, followed by those added
+                 * later in the order they were added. Can be called from
+                 * any thread.
+                 */
+                std::vector<TValue> get_all(const TId id) const {
+                    std::shared_ptr<const main_type> main;
+                    std::shared_ptr<const extra_type> merging;
+                    std::vector<std::pair<TId, operation>> extra;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        main = m_main;
+                        merging = m_merging;
+                        const auto range = m_extra.equal_range(id);
+                        for (auto it = range.first; it != range.second; ++it) {
+                            extra.emplace_back(it->first, it->second);
+                        }
+                    }
+
+                    std::vector<TValue> values;
+                    const auto range = std::equal_range(main->cbegin(), main->cend(), element_type{id, TValue{}}, [](const element_type& a, const element_type& b) {
+                        return a.first < b.first;
+                    });
+                    for (auto it = range.first; it != range.second; ++it) {
+                        values.push_back(it->second);
+                    }
+
+                    if (merging) {
+                        const auto merging_range = merging->equal_range(id);
+                        apply(values, merging_range.first, merging_range.second);
+                    }
+                    apply(values, extra.cbegin(), extra.cend());
+
+                    return values;
+                }
+
+                /**
+                 * Call func(value) for all values for the given id.
+                 */
+                template <typename TFunc>
+                void for_each(const TId id, TFunc&& func) const {
+                    for (const auto& value : get_all(id)) {
+                        func(value);
+                    }
+                }
+
+                /**
+                 * Merge the entries and removals added so far into the main
+                 * part. Can be called from any thread while other threads
+                 * read and write the multimap. If another consolidation is
+                 * running, this waits for it to finish first.
+                 *
+                 * If a background consolidation failed since the last
+                 * call, its exception is rethrown here (only the first one
+                 * if several failed). The entries and
+                 * removals are kept in the extra part in that case, so
+                 * calling consolidate() again will retry merging them.
+                 *
+                 * Do not call this from a task running in the pool used for
+                 * background consolidation.
+                 */
+                void consolidate() {
+                    finish_background();
+                    merge_extra();
+                }
+
+                /**
+                 * Same as consolidate().
+                 */
+                void sort() final {
+                    consolidate();
+                }
+
+                /**
+                 * Consolidate and write the main part to the file
+                 * descriptor.
+                 */
+                void dump_as_list(const int fd) final {
+                    consolidate();
+                    std::shared_ptr<const main_type> main;
+                    {
+                        std::lock_guard<std::mutex> lock{m_mutex};
+                        main = m_main;
+                    }
+                    osmium::io::detail::reliable_write(fd, reinterpret_cast<const char*>(main->data()), main->size() * sizeof(element_type));
+                }
+
+                /**
+                 * Remove all entries. Waits for a running consolidation to
+                 * finish.
+                 */
+                void clear() final {
+                    std::lock_guard<std::mutex> consolidate_lock{m_consolidate_mutex};
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    m_main = std::make_shared<const main_type>();
+                    m_extra.clear();
+                }
+
+            }; // class ConcurrentHybrid
+
+        } // namespace multimap
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_MULTIMAP_CONCURRENT_HYBRID_HPP
@@ -39,6 +39,10 @@ DEALINGS IN THE SOFTWARE.
 
 #define OSMIUM_WANT_NODE_LOCATION_MAPS
 
+#ifdef OSMIUM_HAS_INDEX_MAP_DENSE_CONCURRENT_ARRAY
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseConcurrentArray, dense_concurrent_array)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_DENSE_FILE_ARRAY
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseFileArray, dense_file_array)
 #endif
@@ -51,6 +55,10 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DenseMmapArray, dense_mmap_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_DENSE_PAGED_ARRAY
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::DensePagedArray, dense_paged_array)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_FILE_ARRAY
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseFileArray, sparse_file_array)
 #endif
@@ -59,6 +67,18 @@ DEALINGS IN THE SOFTWARE.
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemArray, sparse_mem_array)
 #endif
 
+#ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_COMPRESSED
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemCompressed, sparse_mem_compressed)
+#endif
+
+#ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_HASH
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemHash, sparse_mem_hash)
+#endif
+
+#ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_INTERPOLATED
+    REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemInterpolated, sparse_mem_interpolated)
+#endif
+
 #ifdef OSMIUM_HAS_INDEX_MAP_SPARSE_MEM_MAP
     REGISTER_MAP(osmium::unsigned_object_id_type, osmium::Location, osmium::index::map::SparseMemMap, sparse_mem_map)
 #endif
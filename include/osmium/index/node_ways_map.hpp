@@ -0,0 +1,592 @@
+#ifndef OSMIUM_INDEX_NODE_WAYS_MAP_HPP
+#define OSMIUM_INDEX_NODE_WAYS_MAP_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/parallel_sort.hpp>
+#include <osmium/index/detail/varint.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/compatibility.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a node ways map file can not be read.
+     */
+    struct OSMIUM_EXPORT node_ways_map_error : public std::runtime_error {
+
+        explicit node_ways_map_error(const char* message) :
+            std::runtime_error(message) {
+        }
+
+        explicit node_ways_map_error(const std::string& message) :
+            std::runtime_error(message) {
+        }
+
+    }; // struct node_ways_map_error
+
+    namespace index {
+
+        /**
+         * Header of a node ways map file. The header is followed by
+         * num_blocks block headers and data_size bytes of encoded data.
+         * All numbers are stored in the native byte order.
+         */
+        struct node_ways_map_header {
+
+            enum : uint32_t {
+                current_version = 1,
+                byte_order_mark = 0x01020304
+            };
+
+            /// Always "OSMNWMAP"
+            char magic[8];
+
+            /// Version of the file format
+            uint32_t version;
+
+            /// Used to detect files written on a machine with another byte order
+            uint32_t byte_order;
+
+            /// Number of distinct node ids
+            uint64_t num_nodes;
+
+            /// Number of (node id, way id) pairs
+            uint64_t num_references;
+
+            /// Number of blocks
+            uint64_t num_blocks;
+
+            /// Size of the encoded data in bytes
+            uint64_t data_size;
+
+        }; // struct node_ways_map_header
+
+        static_assert(sizeof(node_ways_map_header) == 48, "node_ways_map_header must be 48 bytes");
+
+        namespace detail {
+
+            constexpr const char node_ways_map_magic[] = "OSMNWMAP";
+
+            struct node_ways_block {
+                uint64_t first_node_id;
+                uint64_t offset;
+            }; // struct node_ways_block
+
+            struct node_way_ref {
+                uint64_t node;
+                uint64_t way;
+
+                bool operator<(const node_way_ref& other) const noexcept {
+                    return node < other.node || (node == other.node && way < other.way);
+                }
+
+                bool operator==(const node_way_ref& other) const noexcept {
+                    return node == other.node && way == other.way;
+                }
+            }; // struct node_way_ref
+
+            struct node_ways_encoded {
+                std::vector<node_ways_block> blocks;
+                std::vector<unsigned char> data;
+                uint64_t num_nodes = 0;
+            }; // struct node_ways_encoded
+
+            enum : std::size_t {
+                // Number of distinct nodes in a block.
+                node_ways_block_size = 64
+            };
+
+            /**
+             * Encode the sorted and unique references in [first, last)
+             * into blocks. The range must start at the first reference
+             * of a node. Block offsets are relative to the beginning of
+             * the data in the result.
+             */
+            inline void encode_node_ways(const node_way_ref* first, const node_way_ref* last, node_ways_encoded& result) {
+                std::size_t nodes_in_block = node_ways_block_size;
+                uint64_t prev_node = 0;
+                uint64_t prev_first_way = 0;
+
+                while (first != last) {
+                    const uint64_t node = first->node;
+                    if (nodes_in_block == node_ways_block_size) {
+                        result.blocks.push_back(node_ways_block{node, result.data.size()});
+                        nodes_in_block = 0;
+                        prev_node = node;
+                        prev_first_way = 0;
+                    }
+                    ++nodes_in_block;
+                    ++result.num_nodes;
+
+                    const node_way_ref* end = first + 1;
+                    while (end != last && end->node == node) {
+                        ++end;
+                    }
+
+                    append_varint(result.data, node - prev_node);
+                    append_varint(result.data, static_cast<uint64_t>(end - first - 1));
+                    append_varint(result.data, zigzag_encode(static_cast<int64_t>(first->way - prev_first_way)));
+                    for (const node_way_ref* it = first + 1; it != end; ++it) {
+                        append_varint(result.data, it->way - (it - 1)->way);
+                    }
+
+                    prev_node = node;
+                    prev_first_way = first->way;
+                    first = end;
+                }
+            }
+
+        } // namespace detail
+
+        /**
+         * Index for looking up all ways a node is in.
+         *
+         * The index is stored in a compressed sparse row format: Sorted
+         * distinct node ids, each followed by the sorted ids of the ways
+         * the node is in. The node ids are delta encoded, as are the way
+         * ids of each node, and all numbers are stored as varints. The
+         * data is split into blocks of 64 nodes with an uncompressed block
+         * header containing the first node id and the offset of the block
+         * data. A lookup is a binary search over the block headers and a
+         * sequential scan of a single block. This usually needs between
+         * 3 and 5 bytes per node reference compared to the 16 bytes used
+         * by a multimap.
+         *
+         * You can not instantiate such an index yourself, instead you need
+         * to instantiate a NodeWaysMapStash, fill it and then create an
+         * index from it:
+         *
+         * @code
+         * NodeWaysMapStash stash;
+         * ...
+         * void way(const osmium::Way& way) {
+         *    stash.add_way(way);
+         * }
+         * ...
+         * const auto index = stash.build_index();
+         * ...
+         * index.for_each(node_id, [](osmium::unsigned_object_id_type way_id) {
+         *   ...
+         * });
+         * @endcode
+         *
+         * The index can be written to a file with write() and later be
+         * opened again using the constructor taking a file descriptor or
+         * file name. The file is memory mapped read-only, so opening is
+         * instantaneous and several processes opening the same file share
+         * the memory.
+         */
+        class NodeWaysMapIndex {
+
+            friend class NodeWaysMapStash;
+
+            osmium::MemoryMapping m_mapping;
+            node_ways_map_header m_header;
+
+            static osmium::MemoryMapping map_file(const int fd) {
+                const std::size_t size = osmium::file_size(fd);
+                if (size < sizeof(node_ways_map_header)) {
+                    throw node_ways_map_error{"node ways map file too small"};
+                }
+                return osmium::MemoryMapping{size, osmium::MemoryMapping::mapping_mode::readonly, fd};
+            }
+
+            static osmium::MemoryMapping open_and_map_file(const std::string& filename) {
+                const int fd = osmium::io::detail::open_for_reading(filename);
+                try {
+                    osmium::MemoryMapping mapping{map_file(fd)};
+                    osmium::io::detail::reliable_close(fd);
+                    return mapping;
+                } catch (...) {
+                    osmium::io::detail::reliable_close(fd);
+                    throw;
+                }
+            }
+
+            static std::size_t file_size(const node_ways_map_header& header) noexcept {
+                return sizeof(node_ways_map_header) +
+                       header.num_blocks * sizeof(detail::node_ways_block) +
+                       header.data_size;
+            }
+
+            const detail::node_ways_block* blocks_begin() const noexcept {
+                return reinterpret_cast<const detail::node_ways_block*>(m_mapping.get_addr<const char>() + sizeof(node_ways_map_header));
+            }
+
+            const detail::node_ways_block* blocks_end() const noexcept {
+                return blocks_begin() + m_header.num_blocks;
+            }
+
+            const unsigned char* data() const noexcept {
+                return reinterpret_cast<const unsigned char*>(blocks_end());
+            }
+
+            void check_header() const {
+                if (std::memcmp(m_header.magic, detail::node_ways_map_magic, sizeof(m_header.magic)) != 0) {
+                    throw node_ways_map_error{"not a node ways map file"};
+                }
+                if (m_header.version != node_ways_map_header::current_version) {
+                    throw node_ways_map_error{"unsupported node ways map file version " + std::to_string(m_header.version)};
+                }
+                if (m_header.byte_order != node_ways_map_header::byte_order_mark) {
+                    throw node_ways_map_error{"node ways map file was written on a machine with different byte order"};
+                }
+                if (m_mapping.size() != file_size(m_header)) {
+                    throw node_ways_map_error{"node ways map file has wrong size (truncated?)"};
+                }
+            }
+
+            explicit NodeWaysMapIndex(osmium::MemoryMapping&& mapping) :
+                m_mapping(std::move(mapping)),
+                m_header() {
+                std::memcpy(&m_header, m_mapping.get_addr<const char>(), sizeof(node_ways_map_header));
+                check_header();
+            }
+
+            static node_ways_map_header make_header(const std::vector<detail::node_ways_encoded>& parts, const uint64_t num_references) noexcept {
+                node_ways_map_header header{};
+                std::memcpy(header.magic, detail::node_ways_map_magic, sizeof(header.magic));
+                header.version = node_ways_map_header::current_version;
+                header.byte_order = node_ways_map_header::byte_order_mark;
+                header.num_references = num_references;
+                for (const auto& part : parts) {
+                    header.num_nodes += part.num_nodes;
+                    header.num_blocks += part.blocks.size();
+                    header.data_size += part.data.size();
+                }
+                return header;
+            }
+
+            // Assemble index from the encoded parts.
+            NodeWaysMapIndex(const std::vector<detail::node_ways_encoded>& parts, const node_ways_map_header& header) :
+                m_mapping(file_size(header), osmium::MemoryMapping::mapping_mode::write_private),
+                m_header(header) {
+                char* out = m_mapping.get_addr<char>();
+                std::memcpy(out, &m_header, sizeof(node_ways_map_header));
+
+                auto* block = reinterpret_cast<detail::node_ways_block*>(out + sizeof(node_ways_map_header));
+                auto* data = reinterpret_cast<unsigned char*>(block + m_header.num_blocks);
+                uint64_t offset = 0;
+                for (const auto& part : parts) {
+                    for (const auto& b : part.blocks) {
+                        *block++ = detail::node_ways_block{b.first_node_id, b.offset + offset};
+                    }
+                    if (!part.data.empty()) {
+                        std::memcpy(data + offset, part.data.data(), part.data.size());
+                    }
+                    offset += part.data.size();
+                }
+            }
+
+        public:
+
+            /**
+             * Open an index file from a file descriptor. The file
+             * descriptor can be closed after this, the index will stay
+             * usable.
+             *
+             * @throws node_ways_map_error If the file is not a valid node
+             *         ways map file.
+             */
+            explicit NodeWaysMapIndex(const int fd) :
+                NodeWaysMapIndex(map_file(fd)) {
+            }
+
+            /**
+             * Open the index file with the given name.
+             *
+             * @throws std::system_error If the file can not be opened.
+             * @throws node_ways_map_error If the file is not a valid node
+             *         ways map file.
+             */
+            explicit NodeWaysMapIndex(const std::string& filename) :
+                NodeWaysMapIndex(open_and_map_file(filename)) {
+            }
+
+            /**
+             * Find the given node id in the index and call the given
+             * function with the ids of all ways this node is in. The
+             * way ids are sorted.
+             *
+             * Complexity: Logarithmic in the number of blocks plus linear
+             *             in the size of one block.
+             */
+            template <typename TFunc>
+            void for_each(const osmium::unsigned_object_id_type node_id, TFunc&& func) const {
+                const auto* const first = blocks_begin();
+                const auto* const last = blocks_end();
+                const auto* block = std::upper_bound(first, last, node_id, [](const osmium::unsigned_object_id_type id, const detail::node_ways_block& b) {
+                    return id < b.first_node_id;
+                });
+                if (block == first) {
+                    return;
+                }
+                --block;
+
+                const unsigned char* ptr = data() + block->offset;
+                const unsigned char* const end = data() + (block + 1 == last ? m_header.data_size : (block + 1)->offset);
+
+                uint64_t node = block->first_node_id;
+                uint64_t first_way = 0;
+                while (ptr < end) {
+                    node += detail::decode_varint(ptr, end);
+                    const uint64_t count = detail::decode_varint(ptr, end);
+                    first_way += static_cast<uint64_t>(detail::zigzag_decode(detail::decode_varint(ptr, end)));
+                    if (node > node_id) {
+                        return;
+                    }
+                    if (node == node_id) {
+                        uint64_t way = first_way;
+                        func(static_cast<osmium::unsigned_object_id_type>(way));
+                        for (uint64_t i = 0; i < count; ++i) {
+                            way += detail::decode_varint(ptr, end);
+                            func(static_cast<osmium::unsigned_object_id_type>(way));
+                        }
+                        return;
+                    }
+                    for (uint64_t i = 0; i < count; ++i) {
+                        detail::skip_varint(ptr, end);
+                    }
+                }
+            }
+
+            /**
+             * Return the ids of all ways the given node is in.
+             */
+            std::vector<osmium::unsigned_object_id_type> get(const osmium::unsigned_object_id_type node_id) const {
+                std::vector<osmium::unsigned_object_id_type> ways;
+                for_each(node_id, [&ways](const osmium::unsigned_object_id_type way_id) {
+                    ways.push_back(way_id);
+                });
+                return ways;
+            }
+
+            /**
+             * Is this index empty?
+             *
+             * Complexity: Constant.
+             */
+            bool empty() const noexcept {
+                return m_header.num_references == 0;
+            }
+
+            /**
+             * How many (node id, way id) pairs are in this index?
+             *
+             * Complexity: Constant.
+             */
+            std::size_t size() const noexcept {
+                return static_cast<std::size_t>(m_header.num_references);
+            }
+
+            /**
+             * How many distinct node ids are in this index?
+             *
+             * Complexity: Constant.
+             */
+            std::size_t num_nodes() const noexcept {
+                return static_cast<std::size_t>(m_header.num_nodes);
+            }
+
+            /**
+             * The memory used by this index in bytes. This is also the
+             * size of the file written by write().
+             */
+            std::size_t used_memory() const noexcept {
+                return file_size(m_header);
+            }
+
+            /**
+             * Write the index to the file descriptor.
+             *
+             * @throws std::system_error If the file could not be written.
+             */
+            void write(const int fd) const {
+                osmium::io::detail::reliable_write(fd, m_mapping.get_addr<const char>(), file_size(m_header));
+            }
+
+        }; // class NodeWaysMapIndex
+
+        /**
+         * The NodeWaysMapStash is used to collect the data needed to
+         * create a NodeWaysMapIndex. See there for details.
+         *
+         * The stash needs 16 bytes per node reference.
+         */
+        class NodeWaysMapStash {
+
+            std::vector<detail::node_way_ref> m_refs;
+
+#ifndef NDEBUG
+            bool m_valid = true;
+#endif
+
+            // Remove duplicates from the sorted references.
+            void unique() {
+                const auto last = std::unique(m_refs.begin(), m_refs.end());
+                m_refs.erase(last, m_refs.end());
+            }
+
+            NodeWaysMapIndex build(const std::vector<detail::node_ways_encoded>& parts) {
+                const auto num_references = static_cast<uint64_t>(m_refs.size());
+                m_refs.clear();
+                m_refs.shrink_to_fit();
+#ifndef NDEBUG
+                m_valid = false;
+#endif
+                return NodeWaysMapIndex{parts, NodeWaysMapIndex::make_header(parts, num_references)};
+            }
+
+        public:
+
+            /**
+             * Add mapping from node to way in the stash.
+             */
+            void add(const osmium::unsigned_object_id_type node_id, const osmium::unsigned_object_id_type way_id) {
+                assert(m_valid && "You can't use the NodeWaysMapStash any more after calling build_index()");
+                m_refs.push_back(detail::node_way_ref{node_id, way_id});
+            }
+
+            /**
+             * Add mapping from all nodes of the way to the way in the stash.
+             */
+            void add_way(const osmium::Way& way) {
+                assert(m_valid && "You can't use the NodeWaysMapStash any more after calling build_index()");
+                for (const auto& node_ref : way.nodes()) {
+                    m_refs.push_back(detail::node_way_ref{node_ref.positive_ref(), way.positive_id()});
+                }
+            }
+
+            /**
+             * Is this stash empty?
+             *
+             * Complexity: Constant.
+             */
+            bool empty() const noexcept {
+                assert(m_valid && "You can't use the NodeWaysMapStash any more after calling build_index()");
+                return m_refs.empty();
+            }
+
+            /**
+             * How many entries are in this stash?
+             *
+             * Complexity: Constant.
+             */
+            std::size_t size() const noexcept {
+                assert(m_valid && "You can't use the NodeWaysMapStash any more after calling build_index()");
+                return m_refs.size();
+            }
+
+            /**
+             * Build an index from the contents of this stash and return
+             * it.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            NodeWaysMapIndex build_index() {
+                assert(m_valid && "You can't use the NodeWaysMapStash any more after calling build_index()");
+                std::sort(m_refs.begin(), m_refs.end());
+                unique();
+
+                std::vector<detail::node_ways_encoded> parts(1);
+                detail::encode_node_ways(m_refs.data(), m_refs.data() + m_refs.size(), parts.front());
+                return build(parts);
+            }
+
+            /**
+             * Build an index from the contents of this stash using the
+             * threads in the pool and return it. The data is sorted and
+             * encoded in parallel. Lookups in the resulting index give the
+             * same results as in an index built with build_index() without
+             * a pool, but the index is not byte-for-byte identical because
+             * the block boundaries can differ.
+             *
+             * Do not call this from a task running in the same pool.
+             *
+             * After you get the index you can not use the stash any more!
+             */
+            NodeWaysMapIndex build_index(osmium::thread::Pool& pool) {
+                assert(m_valid && "You can't use the NodeWaysMapStash any more after calling build_index()");
+                detail::parallel_sort(m_refs.begin(), m_refs.end(), [](const detail::node_way_ref& ref) {
+                    return ref.node;
+                }, pool);
+                unique();
+
+                // Split the references into ranges which start at the
+                // first reference of a node...
+                const std::size_t size = m_refs.size();
+                const auto num_parts = static_cast<std::size_t>(pool.num_threads());
+                std::vector<std::size_t> starts;
+                starts.reserve(num_parts + 1);
+                for (std::size_t n = 0; n < num_parts; ++n) {
+                    std::size_t start = std::max(size * n / num_parts, starts.empty() ? 0 : starts.back());
+                    while (start > 0 && start < size && m_refs[start].node == m_refs[start - 1].node) {
+                        ++start;
+                    }
+                    starts.push_back(start);
+                }
+                starts.push_back(size);
+
+                // ...and encode them in parallel.
+                std::vector<detail::node_ways_encoded> parts(num_parts);
+                const detail::node_way_ref* refs = m_refs.data();
+                osmium::thread::run_in_parallel(pool, num_parts, [&](const std::size_t n) {
+                    detail::encode_node_ways(refs + starts[n], refs + starts[n + 1], parts[n]);
+                });
+
+                return build(parts);
+            }
+
+        }; // class NodeWaysMapStash
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_NODE_WAYS_MAP_HPP
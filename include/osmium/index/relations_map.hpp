@@ -52,9 +52,13 @@ namespace osmium {
 
         namespace detail {
 
+            struct relations_map_parallel;
+
             template <typename TKey, typename TKeyInternal, typename TValue, typename TValueInternal>
             class flat_map {
 
+                friend struct relations_map_parallel;
+
             public:
 
                 using key_type   = TKey;
@@ -66,6 +70,8 @@ namespace osmium {
                     TKeyInternal key;
                     TValueInternal value;
 
+                    kv_pair() noexcept = default;
+
                     explicit kv_pair(const key_type key_id) :
                         key(static_cast<TKeyInternal>(key_id)),
                         value() {
@@ -119,6 +125,14 @@ namespace osmium {
                     m_map.erase(last, m_map.end());
                 }
 
+                const_iterator begin() const noexcept {
+                    return m_map.cbegin();
+                }
+
+                const_iterator end() const noexcept {
+                    return m_map.cend();
+                }
+
                 std::pair<const_iterator, const_iterator> get(const key_type key) const noexcept {
                     return std::equal_range(m_map.begin(), m_map.end(), kv_pair{key}, [](const kv_pair& lhs, const kv_pair& rhs) {
                         return lhs.key < rhs.key;
@@ -141,6 +155,8 @@ namespace osmium {
 
         } // namespace detail
 
+        class MappedRelationsMapIndex;
+
         /**
          * Index for looking up parent relation IDs given a member relation ID
          * or the other way around.
@@ -165,11 +181,15 @@ namespace osmium {
          * ...
          * @endcode
          *
+         * To store the index in a file, use the MappedRelationsMapIndex
+         * class.
          */
         class RelationsMapIndex {
 
             friend class RelationsMapStash;
             friend class RelationsMapIndexes;
+            friend class MappedRelationsMapIndex;
+            friend struct detail::relations_map_parallel;
 
             using map_type = detail::flat_map<osmium::unsigned_object_id_type, uint32_t,
                                               osmium::unsigned_object_id_type, uint32_t>;
@@ -266,6 +286,7 @@ namespace osmium {
         class RelationsMapIndexes {
 
             friend class RelationsMapStash;
+            friend struct detail::relations_map_parallel;
 
             RelationsMapIndex m_member_to_parent;
             RelationsMapIndex m_parent_to_member;
@@ -312,6 +333,8 @@ namespace osmium {
          */
         class RelationsMapStash {
 
+            friend struct detail::relations_map_parallel;
+
             using map_type = detail::flat_map<osmium::unsigned_object_id_type, uint32_t,
                                               osmium::unsigned_object_id_type, uint32_t>;
 
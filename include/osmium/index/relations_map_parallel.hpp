@@ -0,0 +1,146 @@
+#ifndef OSMIUM_INDEX_RELATIONS_MAP_PARALLEL_HPP
+#define OSMIUM_INDEX_RELATIONS_MAP_PARALLEL_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/index/detail/parallel_sort.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace osmium {
+
+    namespace index {
+
+        namespace detail {
+
+            struct relations_map_parallel {
+
+                template <typename TMap>
+                static void sort_unique(TMap& map, osmium::thread::Pool& pool) {
+                    using kv_pair = typename decltype(map.m_map)::value_type;
+                    parallel_sort(map.m_map.begin(), map.m_map.end(), [](const kv_pair& p) {
+                        return p.key;
+                    }, pool);
+                    const auto last = std::unique(map.m_map.begin(), map.m_map.end());
+                    map.m_map.erase(last, map.m_map.end());
+                }
+
+#ifndef NDEBUG
+                static void invalidate(RelationsMapStash& stash) noexcept {
+                    stash.m_valid = false;
+                }
+#else
+                static void invalidate(RelationsMapStash& /*stash*/) noexcept {
+                }
+#endif
+
+                static RelationsMapIndex build_member_to_parent_index(RelationsMapStash& stash, osmium::thread::Pool& pool) {
+                    assert(stash.m_valid && "You can't use the RelationsMap any more after calling build_member_to_parent_index()");
+                    sort_unique(stash.m_map, pool);
+                    invalidate(stash);
+                    return RelationsMapIndex{std::move(stash.m_map)};
+                }
+
+                static RelationsMapIndex build_parent_to_member_index(RelationsMapStash& stash, osmium::thread::Pool& pool) {
+                    assert(stash.m_valid && "You can't use the RelationsMap any more after calling build_parent_to_member_index()");
+                    stash.m_map.flip_in_place();
+                    sort_unique(stash.m_map, pool);
+                    invalidate(stash);
+                    return RelationsMapIndex{std::move(stash.m_map)};
+                }
+
+                static RelationsMapIndexes build_indexes(RelationsMapStash& stash, osmium::thread::Pool& pool) {
+                    assert(stash.m_valid && "You can't use the RelationsMap any more after calling build_indexes()");
+                    auto reverse_map = stash.m_map.flip_copy();
+                    sort_unique(reverse_map, pool);
+                    sort_unique(stash.m_map, pool);
+                    invalidate(stash);
+                    return RelationsMapIndexes{std::move(stash.m_map), std::move(reverse_map)};
+                }
+
+            }; // struct relations_map_parallel
+
+        } // namespace detail
+
+        /**
+         * Build an index for member to parent lookups from the contents
+         * of the stash using the threads in the pool for sorting and
+         * return it. Does the same as
+         * RelationsMapStash::build_member_to_parent_index().
+         *
+         * Do not call this from a task running in the same pool.
+         *
+         * After you get the index you can not use the stash any more!
+         */
+        inline RelationsMapIndex parallel_build_member_to_parent_index(RelationsMapStash& stash, osmium::thread::Pool& pool) {
+            return detail::relations_map_parallel::build_member_to_parent_index(stash, pool);
+        }
+
+        /**
+         * Build an index for parent to member lookups from the contents
+         * of the stash using the threads in the pool for sorting and
+         * return it. Does the same as
+         * RelationsMapStash::build_parent_to_member_index().
+         *
+         * Do not call this from a task running in the same pool.
+         *
+         * After you get the index you can not use the stash any more!
+         */
+        inline RelationsMapIndex parallel_build_parent_to_member_index(RelationsMapStash& stash, osmium::thread::Pool& pool) {
+            return detail::relations_map_parallel::build_parent_to_member_index(stash, pool);
+        }
+
+        /**
+         * Build indexes for member-to-parent and parent-to-member lookups
+         * from the contents of the stash using the threads in the pool
+         * for sorting and return them. Does the same as
+         * RelationsMapStash::build_indexes(). The two directions are
+         * sorted one after the other, each sort uses all threads.
+         *
+         * Do not call this from a task running in the same pool.
+         *
+         * After you get the indexes you can not use the stash any more!
+         */
+        inline RelationsMapIndexes parallel_build_indexes(RelationsMapStash& stash, osmium::thread::Pool& pool) {
+            return detail::relations_map_parallel::build_indexes(stash, pool);
+        }
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_RELATIONS_MAP_PARALLEL_HPP
@@ -0,0 +1,293 @@
+#ifndef OSMIUM_INDEX_WAY_GEOMETRY_INDEX_HPP
+#define OSMIUM_INDEX_WAY_GEOMETRY_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <osmium/index/detail/mmap_vector_base.hpp>
+#include <osmium/index/detail/varint.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/node_ref.hpp>
+#include <osmium/osm/node_ref_list.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/util/file.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace index {
+
+        /**
+         * Index from way id to the locations of all nodes of the way.
+         *
+         * Fill this index from ways which already have their node
+         * locations set (usually by the NodeLocationsForWays handler),
+         * then, in a later pass, get the complete geometry of a way
+         * with a single lookup instead of re-reading the way and
+         * looking up each of its node locations again. This is useful
+         * when assembling multipolygons or processing route relations.
+         *
+         * The locations of each way are stored in a compact encoding
+         * (a varint count followed by the zigzag-encoded deltas of the
+         * x and y coordinates) in one big arena. The arena is an
+         * anonymous memory mapping or, if a file descriptor is given in
+         * the constructor, a mapping of that file so that it can spill
+         * to disk. For each way the id and the offset of its data in
+         * the arena is kept in a vector which is sorted by id.
+         *
+         * Call sort() after adding all ways and before reading from the
+         * index. This is not needed if the ways are added in order of
+         * their ids, as they usually are in OSM files. The index does
+         * not support duplicate ids.
+         *
+         * Adding and reading is not thread-safe. After sort() the index
+         * can be read from several threads at the same time.
+         */
+        class WayGeometryIndex {
+
+            struct entry {
+                osmium::unsigned_object_id_type id;
+                uint64_t offset;
+
+                bool operator<(const entry& other) const noexcept {
+                    return id < other.id;
+                }
+            }; // struct entry
+
+            osmium::detail::mmap_vector_base<unsigned char> m_data;
+            std::vector<entry> m_entries;
+            std::vector<unsigned char> m_buffer;
+            bool m_sorted = true;
+
+            static int truncate_file(const int fd) {
+                osmium::resize_file(fd, 0);
+                return fd;
+            }
+
+            const entry* find(const osmium::unsigned_object_id_type id) const noexcept {
+                const entry key{id, 0};
+                const auto it = std::lower_bound(m_entries.begin(), m_entries.end(), key);
+                if (it == m_entries.end() || it->id != id) {
+                    return nullptr;
+                }
+                return &*it;
+            }
+
+            template <typename TFunc>
+            void decode(const entry& e, TFunc&& func) const {
+                const unsigned char* data = m_data.data() + e.offset;
+                const unsigned char* const end = m_data.data() + m_data.size();
+
+                auto count = detail::decode_varint(data, end);
+                int64_t x = 0;
+                int64_t y = 0;
+                while (count > 0) {
+                    x += detail::zigzag_decode(detail::decode_varint(data, end));
+                    y += detail::zigzag_decode(detail::decode_varint(data, end));
+                    func(osmium::Location{static_cast<int32_t>(x), static_cast<int32_t>(y)});
+                    --count;
+                }
+            }
+
+        public:
+
+            /**
+             * Create an index with the arena in anonymous memory.
+             */
+            WayGeometryIndex() = default;
+
+            /**
+             * Create an index with the arena in the file with the given
+             * file descriptor. The file is truncated first. It must be
+             * kept open while the index is in use.
+             */
+            explicit WayGeometryIndex(const int fd) :
+                m_data(truncate_file(fd), osmium::detail::mmap_vector_size_increment) {
+            }
+
+            /**
+             * Add the node locations of a way to the index.
+             *
+             * @param id The way id.
+             * @param nodes The way nodes. Nodes without a location are
+             *              stored with an undefined location.
+             */
+            void add(const osmium::unsigned_object_id_type id, const osmium::WayNodeList& nodes) {
+                m_buffer.clear();
+                detail::append_varint(m_buffer, nodes.size());
+                int64_t x = 0;
+                int64_t y = 0;
+                for (const auto& node_ref : nodes) {
+                    const auto& location = node_ref.location();
+                    detail::append_varint(m_buffer, detail::zigzag_encode(location.x() - x));
+                    detail::append_varint(m_buffer, detail::zigzag_encode(location.y() - y));
+                    x = location.x();
+                    y = location.y();
+                }
+
+                const auto offset = m_data.size();
+                m_data.resize(offset + m_buffer.size());
+                std::memcpy(m_data.data() + offset, m_buffer.data(), m_buffer.size());
+
+                if (!m_entries.empty() && m_entries.back().id >= id) {
+                    m_sorted = false;
+                }
+                m_entries.push_back(entry{id, offset});
+            }
+
+            /**
+             * Add the node locations of a way to the index.
+             */
+            void add_way(const osmium::Way& way) {
+                add(way.positive_id(), way.nodes());
+            }
+
+            /**
+             * Sort the index. Call this after adding all ways and before
+             * reading from the index.
+             */
+            void sort() {
+                if (!m_sorted) {
+                    std::sort(m_entries.begin(), m_entries.end());
+                    m_sorted = true;
+                }
+            }
+
+            /**
+             * Is the way with the given id in the index?
+             */
+            bool contains(const osmium::unsigned_object_id_type id) const noexcept {
+                return find(id) != nullptr;
+            }
+
+            /**
+             * Call func with each location of the way with the given id
+             * in the order of the way nodes.
+             *
+             * @returns true if the way was found, false otherwise.
+             */
+            template <typename TFunc>
+            bool for_each_location(const osmium::unsigned_object_id_type id, TFunc&& func) const {
+                const entry* e = find(id);
+                if (!e) {
+                    return false;
+                }
+                decode(*e, std::forward<TFunc>(func));
+                return true;
+            }
+
+            /**
+             * Get the locations of the way with the given id.
+             *
+             * @throws osmium::not_found if the id could not be found.
+             */
+            std::vector<osmium::Location> get(const osmium::unsigned_object_id_type id) const {
+                std::vector<osmium::Location> locations;
+                const bool found = for_each_location(id, [&locations](const osmium::Location& location) {
+                    locations.push_back(location);
+                });
+                if (!found) {
+                    throw osmium::not_found{id};
+                }
+                return locations;
+            }
+
+            /**
+             * Set the locations of the nodes in the way node list from
+             * the index. The node list must have the same number of nodes
+             * as the way stored under the given id.
+             *
+             * @returns true if the way was found and has the same number
+             *          of nodes, false otherwise. In the latter case the
+             *          node list is not changed.
+             */
+            bool set_locations(const osmium::unsigned_object_id_type id, osmium::WayNodeList& nodes) const {
+                const entry* e = find(id);
+                if (!e) {
+                    return false;
+                }
+
+                const unsigned char* data = m_data.data() + e->offset;
+                if (detail::decode_varint(data, m_data.data() + m_data.size()) != nodes.size()) {
+                    return false;
+                }
+
+                auto it = nodes.begin();
+                decode(*e, [&it](const osmium::Location& location) {
+                    it->set_location(location);
+                    ++it;
+                });
+                return true;
+            }
+
+            /// Is the index empty?
+            bool empty() const noexcept {
+                return m_entries.empty();
+            }
+
+            /// The number of ways in the index.
+            std::size_t size() const noexcept {
+                return m_entries.size();
+            }
+
+            /**
+             * The memory used by this index in bytes. This includes the
+             * arena, even if it is backed by a file.
+             */
+            std::size_t used_memory() const noexcept {
+                return m_data.capacity() + m_entries.capacity() * sizeof(entry) + m_buffer.capacity();
+            }
+
+            /**
+             * Remove all ways from the index.
+             */
+            void clear() {
+                m_data.clear();
+                m_entries.clear();
+                m_entries.shrink_to_fit();
+                m_sorted = true;
+            }
+
+        }; // class WayGeometryIndex
+
+    } // namespace index
+
+} // namespace osmium
+
+#endif // OSMIUM_INDEX_WAY_GEOMETRY_INDEX_HPP
@@ -0,0 +1,158 @@
+#ifndef OSMIUM_IO_ADD_LOCATIONS_ON_WAYS_HPP
+#define OSMIUM_IO_ADD_LOCATIONS_ON_WAYS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2023 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/handler/node_locations_for_ways_parallel.hpp>
+#include <osmium/index/id_set.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * What add_locations_on_ways() should do with nodes without tags.
+         */
+        enum class untagged_nodes {
+            remove       = 0, ///< Remove all untagged nodes.
+            keep_members = 1, ///< Keep untagged nodes that are members of relations.
+            keep         = 2  ///< Keep all nodes.
+        };
+
+        /**
+         * Add the ids of all nodes that are members of relations in the
+         * input file to the set.
+         */
+        inline void collect_member_nodes(const osmium::io::File& input, osmium::index::IdSetDense<osmium::unsigned_object_id_type>& ids) {
+            osmium::io::Reader reader{input, osmium::osm_entity_bits::relation};
+            while (osmium::memory::Buffer buffer = reader.read()) {
+                for (const auto& relation : buffer.select<osmium::Relation>()) {
+                    for (const auto& member : relation.members()) {
+                        if (member.type() == osmium::item_type::node) {
+                            ids.set(member.positive_ref());
+                        }
+                    }
+                }
+            }
+            reader.close();
+        }
+
+        /**
+         * Copy all data from the input file to the writer and add the node
+         * locations to the ways. Ways are resolved on the threads of the
+         * pool using osmium::handler::process_buffer(). Node and way passes
+         * are done in one pass over the input, so it must be sorted by
+         * type.
+         *
+         * Untagged nodes are usually only needed for their locations.
+         * By default they are not written unless they are members of
+         * relations, so that the output doesn't contain relations with
+         * missing members. To find those nodes, this reads the relations
+         * from the input in an extra pass first.
+         *
+         * To get a PBF file with the "LocationsOnWays" feature, open the
+         * writer with the "locations_on_ways=true" file option:
+         *
+         * @code
+         * osmium::io::File input{"input.osm.pbf"};
+         * osmium::io::Header header = osmium::io::Reader{input, osmium::osm_entity_bits::nothing}.header();
+         * osmium::io::Writer writer{osmium::io::File{"output.osm.pbf", "pbf,locations_on_ways=true"}, header};
+         * index_type index;
+         * osmium::handler::NodeLocationsForWays<index_type> location_handler{index};
+         * osmium::io::add_locations_on_ways(input, writer, location_handler, pool);
+         * writer.close();
+         * @endcode
+         *
+         * Do not call this from inside a task running in the same pool.
+         *
+         * @param input The input file.
+         * @param writer The output. It is not closed.
+         * @param location_handler Handler storing the node locations.
+         *                         Configure it as needed, for instance with
+         *                         ignore_errors().
+         * @param pool Thread pool for resolving the ways.
+         * @param nodes Which untagged nodes should be written.
+         */
+        template <typename TStoragePosIDs, typename TStorageNegIDs>
+        void add_locations_on_ways(const osmium::io::File& input,
+                                   osmium::io::Writer& writer,
+                                   osmium::handler::NodeLocationsForWays<TStoragePosIDs, TStorageNegIDs>& location_handler,
+                                   osmium::thread::Pool& pool,
+                                   const untagged_nodes nodes = untagged_nodes::keep_members) {
+            osmium::index::IdSetDense<osmium::unsigned_object_id_type> member_nodes;
+            if (nodes == untagged_nodes::keep_members) {
+                collect_member_nodes(input, member_nodes);
+            }
+
+            osmium::io::Reader reader{input};
+            while (osmium::memory::Buffer buffer = reader.read()) {
+                osmium::handler::process_buffer(location_handler, buffer, pool);
+
+                if (nodes != untagged_nodes::keep) {
+                    bool removed = false;
+                    for (auto& node : buffer.select<osmium::Node>()) {
+                        if (node.tags().empty() && !member_nodes.get(node.positive_id())) {
+                            node.set_removed(true);
+                            removed = true;
+                        }
+                    }
+                    if (removed) {
+                        buffer.purge_removed();
+                    }
+                }
+
+                if (buffer.committed() > 0) {
+                    writer(std::move(buffer));
+                }
+            }
+            reader.close();
+        }
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_ADD_LOCATIONS_ON_WAYS_HPP
@@ -919,6 +919,8 @@ namespace osmium {
                                 header.set("pbf_optional_feature_" + std::to_string(i++), opt);
                                 if (opt == "Sort.Type_then_ID") {
                                     header.set("sorting", "Type_then_ID");
+                                } else if (opt == "LocationsOnWays") {
+                                    header.set("locations_on_ways", true);
                                 }
                             }
                             break;
@@ -442,6 +442,17 @@ namespace osmium {
             void after_relation(const osmium::Relation& /*relation*/) const noexcept {
             }
 
+            /**
+             * This method is called before the output buffer is flushed at
+             * the end of the second pass or read with read().
+             *
+             * Overwrite this method in a derived class if it produces
+             * output asynchronously and has to add it to the output buffer
+             * before it is handed out.
+             */
+            void before_flush_output() const noexcept {
+            }
+
             TManager& derived() noexcept {
                 return *static_cast<TManager*>(this);
             }
@@ -547,6 +558,18 @@ namespace osmium {
                 }
             }
 
+            /// Flush the output buffer.
+            void flush_output() {
+                derived().before_flush_output();
+                RelationsManagerBase::flush_output();
+            }
+
+            /// Return the contents of the output buffer.
+            osmium::memory::Buffer read() {
+                derived().before_flush_output();
+                return RelationsManagerBase::read();
+            }
+
             /**
              * Call this function it will call your function back for every
              * incomplete relation, that is all relations that have missing
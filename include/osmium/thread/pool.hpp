@@ -239,6 +239,40 @@ namespace osmium {
 
         }; // class Pool
 
+        /**
+         * Run func(n) for all n in [0, count) as separate tasks in the
+         * pool and wait until all of them are done. If any of the tasks
+         * throws an exception, the first of them is re-thrown after all
+         * tasks have finished.
+         *
+         * Do not call this from inside a task running in the same pool,
+         * because that could dead-lock when all pool threads are waiting.
+         *
+         * @param pool The thread pool to use.
+         * @param count The number of tasks to run.
+         * @param func Function called with the task number.
+         */
+        template <typename TFunction>
+        inline void run_in_parallel(Pool& pool, const std::size_t count, TFunction&& func) {
+            std::vector<std::future<void>> futures;
+            futures.reserve(count);
+
+            for (std::size_t n = 0; n < count; ++n) {
+                futures.push_back(pool.submit([&func, n]() {
+                    func(n);
+                }));
+            }
+
+            // The tasks access data owned by the caller, so we have to
+            // wait for all of them before an exception can be propagated.
+            for (auto& future : futures) {
+                future.wait();
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+        }
+
     } // namespace thread
 
 } // namespace osmium
@@ -0,0 +1,113 @@
+#include "catch.hpp"
+
+#include <osmium/area/assembler.hpp>
+#include <osmium/area/multipolygon_manager.hpp>
+#include <osmium/builder/attr.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <iterator>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+namespace {
+
+    // Creates n square multipolygon relations, each with one way member,
+    // and n closed tagged ways that are not members of any relation.
+    osmium::memory::Buffer create_data(int n) {
+        osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+        for (int i = 0; i < 2 * n; ++i) {
+            const double x = i * 0.05;
+            const osmium::object_id_type nid = 4 * i + 1;
+            osmium::builder::add_way(buffer,
+                _id(i + 1),
+                _tag("building", "yes"),
+                _nodes({
+                    {nid,     {x,        0.0}},
+                    {nid + 1, {x,        0.02}},
+                    {nid + 2, {x + 0.02, 0.02}},
+                    {nid + 3, {x + 0.02, 0.0}},
+                    {nid,     {x,        0.0}}
+                })
+            );
+        }
+
+        for (int i = 0; i < n; ++i) {
+            osmium::builder::add_relation(buffer,
+                _id(i + 1),
+                _tag("type", "multipolygon"),
+                _tag("landuse", "forest"),
+                _member(osmium::item_type::way, 2 * i + 1, "outer")
+            );
+        }
+
+        return buffer;
+    }
+
+    std::vector<osmium::object_id_type> build_areas(const osmium::memory::Buffer& data, osmium::thread::Pool* pool, osmium::area::area_stats* stats) {
+        const osmium::area::Assembler::config_type config;
+        osmium::area::MultipolygonManager<osmium::area::Assembler> manager{config};
+        if (pool) {
+            manager.use_thread_pool(*pool);
+        }
+
+        for (const auto& relation : data.select<osmium::Relation>()) {
+            manager.relation(relation);
+        }
+        manager.prepare_for_lookup();
+
+        std::vector<osmium::object_id_type> ids;
+        osmium::apply(data, manager.handler([&ids](osmium::memory::Buffer&& buffer) {
+            for (const auto& area : buffer.select<osmium::Area>()) {
+                ids.push_back(area.id());
+            }
+        }));
+
+        *stats = manager.stats();
+        return ids;
+    }
+
+} // anonymous namespace
+
+TEST_CASE("Multipolygon manager assembles areas on thread pool in serial order") {
+    const auto data = create_data(1000);
+
+    osmium::area::area_stats serial_stats;
+    const auto serial = build_areas(data, nullptr, &serial_stats);
+    REQUIRE(serial.size() == 3000);
+
+    osmium::thread::Pool pool{4};
+    osmium::area::area_stats parallel_stats;
+    const auto parallel = build_areas(data, &pool, &parallel_stats);
+
+    REQUIRE(parallel == serial);
+    REQUIRE(parallel_stats.from_ways == serial_stats.from_ways);
+    REQUIRE(parallel_stats.from_relations == serial_stats.from_relations);
+    REQUIRE(parallel_stats.nodes == serial_stats.nodes);
+}
+
+TEST_CASE("Multipolygon manager with thread pool returns all areas from read()") {
+    const auto data = create_data(10);
+
+    const osmium::area::Assembler::config_type config;
+    osmium::area::MultipolygonManager<osmium::area::Assembler> manager{config};
+    osmium::thread::Pool pool{2};
+    manager.use_thread_pool(pool);
+
+    for (const auto& relation : data.select<osmium::Relation>()) {
+        manager.relation(relation);
+    }
+    manager.prepare_for_lookup();
+
+    for (const auto& way : data.select<osmium::Way>()) {
+        manager.handle_way(way);
+    }
+
+    const auto buffer = manager.read();
+    REQUIRE(std::distance(buffer.select<osmium::Area>().begin(), buffer.select<osmium::Area>().end()) == 30);
+    REQUIRE(manager.stats().from_relations == 10);
+}
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/extract/reference_complete.hpp>
+#include <osmium/io/opl_input.hpp>
+#include <osmium/io/opl_output.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <string>
+#include <vector>
+
+static std::vector<std::string> read_ids(const std::string& filename) {
+    std::vector<std::string> ids;
+
+    osmium::io::Reader reader{filename};
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            ids.push_back(osmium::item_type_to_char(object.type()) + std::to_string(object.id()));
+        }
+    }
+    reader.close();
+
+    return ids;
+}
+
+static std::vector<std::string> write_extract(osmium::extract::ReferenceCompleteExtract& extract) {
+    const std::string filename{"test-reference-complete-out.opl"};
+    osmium::io::Writer writer{filename, extract.header(), osmium::io::overwrite::allow};
+    extract.write(writer);
+    writer.close();
+
+    return read_ids(filename);
+}
+
+TEST_CASE("Reference complete extract with nested relations") {
+    osmium::thread::Pool pool{2};
+    osmium::extract::ReferenceCompleteExtract extract{osmium::io::File{with_data_dir("t/extract/data.opl")}, pool};
+
+    extract.ids(osmium::item_type::relation).set(31);
+    extract.complete();
+
+    REQUIRE(extract.ids(osmium::item_type::relation).get(30));
+    REQUIRE(extract.ids(osmium::item_type::way).get(20));
+    REQUIRE(extract.ids(osmium::item_type::node).get(1));
+
+    const std::vector<std::string> expected = {"n1", "n2", "n3", "n5", "w20", "r30", "r31"};
+    REQUIRE(write_extract(extract) == expected);
+}
+
+TEST_CASE("Reference complete extract of a region") {
+    osmium::thread::Pool pool{2};
+    osmium::extract::ReferenceCompleteExtract extract{osmium::io::File{with_data_dir("t/extract/data.opl")}, pool};
+
+    // the region contains only node 4
+    extract.select([](const osmium::OSMObject& object) {
+        return object.type() == osmium::item_type::node && object.id() == 4;
+    });
+    extract.complete();
+
+    const std::vector<std::string> expected = {"n3", "n4", "w21"};
+    REQUIRE(write_extract(extract) == expected);
+}
+
+TEST_CASE("Reference complete extract with relation member of selected region") {
+    osmium::thread::Pool pool{2};
+    osmium::extract::ReferenceCompleteExtract extract{osmium::io::File{with_data_dir("t/extract/data.opl")}, pool};
+    extract.assume_sorted();
+
+    // the region contains only node 9
+    extract.select([](const osmium::OSMObject& object) {
+        return object.type() == osmium::item_type::node && object.id() == 9;
+    });
+    extract.complete();
+
+    const std::vector<std::string> expected = {"n8", "n9", "w22", "r32"};
+    REQUIRE(write_extract(extract) == expected);
+}
+
+TEST_CASE("Reference complete extract without selection is empty") {
+    osmium::extract::ReferenceCompleteExtract extract{osmium::io::File{with_data_dir("t/extract/data.opl")}};
+    extract.complete();
+
+    REQUIRE(write_extract(extract).empty());
+}
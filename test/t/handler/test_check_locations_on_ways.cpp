@@ -0,0 +1,47 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/check_locations_on_ways.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/visitor.hpp>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+TEST_CASE("CheckLocationsOnWays accepts ways with locations") {
+    osmium::memory::Buffer buffer{10240};
+    osmium::builder::add_way(buffer, _id(1), _nodes({
+        osmium::NodeRef{1, osmium::Location{1.0, 2.0}},
+        osmium::NodeRef{2, osmium::Location{1.5, 2.5}}
+    }));
+
+    osmium::handler::CheckLocationsOnWays handler{1};
+    osmium::apply(buffer, handler);
+    REQUIRE(handler.count() == 1);
+    REQUIRE(handler.checked() == 1);
+}
+
+TEST_CASE("CheckLocationsOnWays detects ways without locations") {
+    osmium::memory::Buffer buffer{10240};
+    osmium::builder::add_way(buffer, _id(1), _nodes({1, 2}));
+
+    osmium::handler::CheckLocationsOnWays handler;
+    REQUIRE_THROWS_AS(osmium::apply(buffer, handler), osmium::not_found);
+}
+
+TEST_CASE("CheckLocationsOnWays only checks sampled ways") {
+    osmium::memory::Buffer buffer{10240};
+    osmium::builder::add_way(buffer, _id(1), _nodes({
+        osmium::NodeRef{1, osmium::Location{1.0, 2.0}}
+    }));
+    osmium::builder::add_way(buffer, _id(2), _nodes({1, 2}));
+    osmium::builder::add_way(buffer, _id(3), _nodes({
+        osmium::NodeRef{1, osmium::Location{1.0, 2.0}}
+    }));
+
+    osmium::handler::CheckLocationsOnWays handler{2};
+    osmium::apply(buffer, handler);
+    REQUIRE(handler.count() == 3);
+    REQUIRE(handler.checked() == 2);
+}
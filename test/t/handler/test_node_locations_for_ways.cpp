@@ -0,0 +1,200 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/index.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_map.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <iterator>
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type, index_type>;
+
+static void add_nodes(osmium::memory::Buffer& buffer) {
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0));
+    osmium::builder::add_node(buffer, _id(2), _location(2.0, 1.0));
+    osmium::builder::add_node(buffer, _id(3), _location(3.0, 1.0));
+    osmium::builder::add_node(buffer, _id(-4), _location(4.0, 1.0));
+    osmium::builder::add_node(buffer, _id(10), _location(10.0, 1.0));
+}
+
+TEST_CASE("NodeLocationsForWays adds locations to ways") {
+    osmium::memory::Buffer buffer{10240};
+    add_nodes(buffer);
+    const auto wpos = osmium::builder::add_way(buffer, _id(1), _nodes({10, 2, -4, 1, 3, 2, 10}));
+
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+
+    for (auto& node : buffer.select<osmium::Node>()) {
+        handler.node(node);
+    }
+
+    auto& way = buffer.get<osmium::Way>(wpos);
+    handler.way(way);
+
+    const auto& nodes = way.nodes();
+    REQUIRE(nodes.size() == 7);
+    REQUIRE(nodes[0].location() == osmium::Location(10.0, 1.0));
+    REQUIRE(nodes[1].location() == osmium::Location(2.0, 1.0));
+    REQUIRE(nodes[2].location() == osmium::Location(4.0, 1.0));
+    REQUIRE(nodes[3].location() == osmium::Location(1.0, 1.0));
+    REQUIRE(nodes[4].location() == osmium::Location(3.0, 1.0));
+    REQUIRE(nodes[5].location() == osmium::Location(2.0, 1.0));
+    REQUIRE(nodes[6].location() == osmium::Location(10.0, 1.0));
+}
+
+TEST_CASE("NodeLocationsForWays with missing nodes") {
+    osmium::memory::Buffer buffer{10240};
+    add_nodes(buffer);
+    const auto wpos = osmium::builder::add_way(buffer, _id(1), _nodes({1, 5, 2}));
+
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+
+    for (auto& node : buffer.select<osmium::Node>()) {
+        handler.node(node);
+    }
+
+    auto& way = buffer.get<osmium::Way>(wpos);
+    REQUIRE_THROWS_AS(handler.way(way), osmium::not_found);
+
+    handler.ignore_errors();
+    handler.way(way);
+
+    const auto& nodes = way.nodes();
+    REQUIRE(nodes[0].location() == osmium::Location(1.0, 1.0));
+    REQUIRE_FALSE(nodes[1].location());
+    REQUIRE(nodes[2].location() == osmium::Location(2.0, 1.0));
+}
+
+TEST_CASE("NodeLocationsForWays handling many ways with prefetching") {
+    using dense_index_type = osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    osmium::memory::Buffer buffer{10240};
+    add_nodes(buffer);
+    osmium::builder::add_way(buffer, _id(1), _nodes({1, 2}));
+    osmium::builder::add_way(buffer, _id(2), _nodes({3, 10, -4}));
+    osmium::builder::add_way(buffer, _id(3), _nodes({2}));
+    osmium::builder::add_way(buffer, _id(4), _nodes({10, 1, 2, 3, 1}));
+
+    dense_index_type index_pos;
+    dense_index_type index_neg;
+    osmium::handler::NodeLocationsForWays<dense_index_type, dense_index_type> handler{index_pos, index_neg};
+
+    for (auto& node : buffer.select<osmium::Node>()) {
+        handler.node(node);
+    }
+
+    for (const std::size_t distance : {0, 1, 2, 100}) {
+        handler.set_prefetch_distance(distance);
+
+        auto ways = buffer.select<osmium::Way>();
+        for (auto& way : ways) {
+            for (auto& node_ref : way.nodes()) {
+                node_ref.set_location(osmium::Location{});
+            }
+        }
+
+        handler.ways(ways.begin(), ways.end());
+
+        for (const auto& way : ways) {
+            for (const auto& node_ref : way.nodes()) {
+                REQUIRE(node_ref.location());
+                REQUIRE(node_ref.location() == handler.get_node_location(node_ref.ref()));
+            }
+        }
+    }
+}
+
+namespace {
+
+    class prefetch_counting_index : public osmium::index::map::SparseMemMap<osmium::unsigned_object_id_type, osmium::Location> {
+
+    public:
+
+        mutable std::size_t count = 0;
+
+        void prefetch(const osmium::unsigned_object_id_type /*id*/) const noexcept override {
+            ++count;
+        }
+
+    }; // class prefetch_counting_index
+
+} // anonymous namespace
+
+TEST_CASE("NodeLocationsForWays prefetches only following ways") {
+    osmium::memory::Buffer buffer{10240};
+    add_nodes(buffer);
+    osmium::builder::add_way(buffer, _id(1), _nodes({1, 2}));
+    osmium::builder::add_way(buffer, _id(2), _nodes({3, 10}));
+    osmium::builder::add_way(buffer, _id(3), _nodes({2}));
+
+    prefetch_counting_index index_pos;
+    prefetch_counting_index index_neg;
+    osmium::handler::NodeLocationsForWays<prefetch_counting_index, prefetch_counting_index> handler{index_pos, index_neg};
+
+    for (auto& node : buffer.select<osmium::Node>()) {
+        handler.node(node);
+    }
+
+    auto ways = buffer.select<osmium::Way>();
+
+    handler.set_prefetch_distance(0);
+    handler.ways(ways.begin(), ways.end());
+    REQUIRE(index_pos.count == 0);
+
+    handler.set_prefetch_distance(100);
+    handler.ways(ways.begin(), ways.end());
+    REQUIRE(index_pos.count == 3);
+}
+
+TEST_CASE("NodeLocationsForWays adds locations to ways with sorted join") {
+    osmium::memory::Buffer buffer{10240};
+    add_nodes(buffer);
+    osmium::builder::add_way(buffer, _id(1), _nodes({10, 2, -4, 1, 3, 2, 10}));
+    osmium::builder::add_way(buffer, _id(2), _nodes({3, 1, -4}));
+    osmium::builder::add_way(buffer, _id(3), _nodes({2}));
+
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+
+    handler.join_buffer(buffer);
+
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        for (const auto& node_ref : way.nodes()) {
+            REQUIRE(node_ref.location());
+            REQUIRE(node_ref.location() == handler.get_node_location(node_ref.ref()));
+        }
+    }
+}
+
+TEST_CASE("NodeLocationsForWays with sorted join throws if location is missing") {
+    osmium::memory::Buffer buffer{10240};
+    add_nodes(buffer);
+    osmium::builder::add_way(buffer, _id(1), _nodes({1, 2}));
+    osmium::builder::add_way(buffer, _id(2), _nodes({1, 5}));
+
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+
+    REQUIRE_THROWS_AS(handler.join_buffer(buffer), osmium::not_found);
+
+    auto ways = buffer.select<osmium::Way>();
+    handler.ignore_errors();
+    handler.join_ways(ways.begin(), ways.end());
+    REQUIRE(ways.begin()->nodes()[1].location() == osmium::Location(2.0, 1.0));
+    REQUIRE_FALSE(std::next(ways.begin())->nodes()[1].location());
+}
@@ -0,0 +1,102 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/handler/node_locations_for_ways_parallel.hpp>
+#include <osmium/index/id_set_concurrent.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type, index_type>;
+
+TEST_CASE("NodeLocationsForWays resolves ways in buffer on thread pool") {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        osmium::builder::add_node(buffer, _id(id), _location(static_cast<double>(id) / 100, 1.0));
+    }
+    for (osmium::object_id_type id = 1; id <= 2000; ++id) {
+        const std::vector<osmium::object_id_type> nodes = {(id * 7) % 1000 + 1, (id * 13) % 1000 + 1, id % 1000 + 1};
+        osmium::builder::add_way(buffer, _id(id), _nodes(nodes));
+    }
+
+    osmium::thread::Pool pool{3};
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+
+    osmium::handler::process_buffer(handler, buffer, pool);
+
+    REQUIRE(index_pos.size() == 1000);
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        for (const auto& node_ref : way.nodes()) {
+            REQUIRE(node_ref.location() == osmium::Location(static_cast<double>(node_ref.ref()) / 100, 1.0));
+        }
+    }
+}
+
+TEST_CASE("NodeLocationsForWays on thread pool throws if location is missing") {
+    osmium::memory::Buffer buffer{10240};
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 1.0));
+    osmium::builder::add_node(buffer, _id(2), _location(2.0, 1.0));
+    osmium::builder::add_way(buffer, _id(1), _nodes({1, 2, 5}));
+
+    osmium::thread::Pool pool{2};
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+
+    REQUIRE_THROWS_AS(osmium::handler::process_buffer(handler, buffer, pool), osmium::not_found);
+
+    handler.ignore_errors();
+    osmium::handler::process_buffer(handler, buffer, pool);
+}
+
+TEST_CASE("NodeLocationsForWays only storing needed nodes") {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        osmium::builder::add_node(buffer, _id(id), _location(static_cast<double>(id) / 100, 1.0));
+    }
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        const std::vector<osmium::object_id_type> nodes = {id, id % 1000 + 1};
+        if (id % 10 == 0) {
+            osmium::builder::add_way(buffer, _id(id), _nodes(nodes), _tag("highway", "primary"));
+        } else {
+            osmium::builder::add_way(buffer, _id(id), _nodes(nodes));
+        }
+    }
+
+    osmium::thread::Pool pool{3};
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> needed_nodes;
+    osmium::handler::collect_needed_nodes(buffer, pool, needed_nodes, [](const osmium::Way& way) {
+        return way.tags().has_key("highway");
+    });
+    REQUIRE(needed_nodes.size() == 200);
+    REQUIRE(needed_nodes.get(10));
+    REQUIRE(needed_nodes.get(11));
+    REQUIRE_FALSE(needed_nodes.get(12));
+
+    index_type index_pos;
+    index_type index_neg;
+    location_handler_type handler{index_pos, index_neg};
+    handler.only_store_nodes(&needed_nodes);
+    handler.ignore_errors();
+
+    osmium::handler::process_buffer(handler, buffer, pool);
+
+    REQUIRE(index_pos.size() == 200);
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        if (way.tags().has_key("highway")) {
+            for (const auto& node_ref : way.nodes()) {
+                REQUIRE(node_ref.location() == osmium::Location(static_cast<double>(node_ref.ref()) / 100, 1.0));
+            }
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include "catch.hpp"
+
+#include <osmium/index/multimap/concurrent_hybrid.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using multimap_type = osmium::index::multimap::ConcurrentHybrid<uint64_t, uint64_t>;
+using values_type = std::vector<uint64_t>;
+
+TEST_CASE("ConcurrentHybrid basic use") {
+    multimap_type map;
+    REQUIRE(map.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(map.get_all(1).empty());
+
+    map.set(1, 10);
+    map.set(2, 20);
+    map.set(1, 11);
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.extra_size() == 3);
+    REQUIRE(map.get_all(1) == (values_type{10, 11}));
+    REQUIRE(map.get_all(2) == values_type{20});
+
+    map.consolidate();
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.extra_size() == 0);
+    REQUIRE(map.get_all(1) == (values_type{10, 11}));
+    REQUIRE(map.get_all(3).empty());
+
+    map.set(1, 5);
+    map.remove(1, 10);
+    map.remove(2, 99);
+    REQUIRE(map.get_all(1) == (values_type{11, 5}));
+    REQUIRE(map.get_all(2) == values_type{20});
+
+    map.consolidate();
+    REQUIRE(map.size() == 3);
+    REQUIRE(map.get_all(1) == (values_type{5, 11}));
+
+    values_type values;
+    map.for_each(1, [&values](uint64_t value) {
+        values.push_back(value);
+    });
+    REQUIRE(values == (values_type{5, 11}));
+
+    map.remove(1, 5);
+    map.set(1, 5);
+    REQUIRE(map.get_all(1) == (values_type{11, 5}));
+    map.consolidate();
+    REQUIRE(map.get_all(1) == (values_type{5, 11}));
+
+    map.clear();
+    REQUIRE(map.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(map.get_all(1).empty());
+}
+
+TEST_CASE("ConcurrentHybrid with readers, writers, and background consolidation") {
+    osmium::thread::Pool pool{2};
+    const uint64_t num_ids = 20000;
+    multimap_type map{pool, 1000};
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> errors{0};
+
+    // Every id gets the values id and id + 1, the value id + 1 is removed
+    // again later. Readers check that they never see anything else.
+    std::thread writer{[&]() {
+        for (uint64_t id = 0; id < num_ids; ++id) {
+            map.set(id, id);
+            map.set(id, id + 1);
+        }
+        for (uint64_t id = 0; id < num_ids; ++id) {
+            map.remove(id, id + 1);
+        }
+        done = true;
+    }};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&]() {
+            uint64_t id = 0;
+            while (!done) {
+                const auto values = map.get_all(id);
+                for (const auto value : values) {
+                    if (value != id && value != id + 1) {
+                        ++errors;
+                    }
+                }
+                if (values.size() > 2) {
+                    ++errors;
+                }
+                id = (id + 7) % num_ids;
+            }
+        });
+    }
+
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    REQUIRE(errors == 0);
+
+    map.consolidate();
+    REQUIRE(map.extra_size() == 0);
+    REQUIRE(map.size() == num_ids);
+    for (uint64_t id = 0; id < num_ids; id += 13) {
+        REQUIRE(map.get_all(id) == values_type{id});
+    }
+}
+
+namespace {
+
+    // Value type whose copy fails a given number of times when copied on
+    // a thread other than the main thread.
+    struct fragile_value {
+
+        static std::atomic<int> failures;
+        static std::thread::id main_thread;
+
+        uint64_t value = 0;
+
+        fragile_value() = default;
+
+        explicit fragile_value(uint64_t v) :
+            value(v) {
+        }
+
+        fragile_value(const fragile_value& other) :
+            value(other.value) {
+            if (std::this_thread::get_id() != main_thread && failures.fetch_sub(1) > 0) {
+                throw std::runtime_error{"copy failed"};
+            }
+        }
+
+        fragile_value& operator=(const fragile_value&) = default;
+
+        ~fragile_value() = default;
+
+        bool operator<(const fragile_value& other) const noexcept {
+            return value < other.value;
+        }
+
+        bool operator==(const fragile_value& other) const noexcept {
+            return value == other.value;
+        }
+
+    }; // struct fragile_value
+
+    std::atomic<int> fragile_value::failures{0};
+    std::thread::id fragile_value::main_thread;
+
+} // anonymous namespace
+
+TEST_CASE("ConcurrentHybrid reports failed background consolidation") {
+    osmium::thread::Pool pool{1};
+    osmium::index::multimap::ConcurrentHybrid<uint64_t, fragile_value> map{pool, 10};
+
+    fragile_value::main_thread = std::this_thread::get_id();
+    fragile_value::failures = 1;
+
+    for (uint64_t id = 0; id < 10; ++id) {
+        map.set(id, fragile_value{id});
+    }
+
+    REQUIRE_THROWS_AS(map.consolidate(), std::runtime_error);
+
+    // The entries are still there and can be consolidated again.
+    REQUIRE(map.extra_size() == 10);
+    map.consolidate();
+    REQUIRE(map.extra_size() == 0);
+    REQUIRE(map.size() == 10);
+    REQUIRE(map.get_all(3) == std::vector<fragile_value>{fragile_value{3}});
+}
+
+TEST_CASE("ConcurrentHybrid does not report failed background consolidation from set()") {
+    osmium::thread::Pool pool{1};
+    osmium::index::multimap::ConcurrentHybrid<uint64_t, fragile_value> map{pool, 10};
+
+    fragile_value::main_thread = std::this_thread::get_id();
+    fragile_value::failures = 1;
+
+    for (uint64_t id = 0; id < 10; ++id) {
+        map.set(id, fragile_value{id});
+    }
+
+    // Wait for the failed background consolidation to finish. The pool
+    // has only one thread, so it runs the tasks in order.
+    pool.submit([]() {}).wait();
+
+    // This starts another background consolidation.
+    for (uint64_t id = 10; id < 20; ++id) {
+        REQUIRE_NOTHROW(map.set(id, fragile_value{id}));
+    }
+
+    REQUIRE_THROWS_AS(map.consolidate(), std::runtime_error);
+    map.consolidate();
+    REQUIRE(map.size() == 20);
+    for (uint64_t id = 0; id < 20; ++id) {
+        REQUIRE(map.get_all(id) == std::vector<fragile_value>{fragile_value{id}});
+    }
+}
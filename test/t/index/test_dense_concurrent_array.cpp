@@ -0,0 +1,105 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/dense_concurrent_array.hpp>
+#include <osmium/index/node_locations_map.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using index_type = osmium::index::map::DenseConcurrentArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id), -static_cast<int32_t>(id)};
+}
+
+TEST_CASE("DenseConcurrentArray: empty index") {
+    index_type index;
+
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.get_noexcept(0) == osmium::Location{});
+    REQUIRE(index.get_noexcept(17) == osmium::Location{});
+    REQUIRE_THROWS_AS(index.get(17), osmium::not_found);
+    REQUIRE_THROWS_AS(index.set(17, location_for(17)), std::out_of_range);
+}
+
+TEST_CASE("DenseConcurrentArray: max id") {
+    index_type index{100};
+
+    REQUIRE(index.size() == 101);
+
+    index.set(0, osmium::Location{0, 0});
+    index.set(100, location_for(100));
+    REQUIRE_THROWS_AS(index.set(101, location_for(101)), std::out_of_range);
+
+    REQUIRE(index.get(0) == osmium::Location(0, 0));
+    REQUIRE(index.get(100) == location_for(100));
+    REQUIRE(index.get_noexcept(50) == osmium::Location{});
+    REQUIRE(index.get_noexcept(101) == osmium::Location{});
+}
+
+TEST_CASE("DenseConcurrentArray: reserve keeps data") {
+    index_type index{10};
+    index.set(5, location_for(5));
+
+    index.reserve(100000);
+    REQUIRE(index.size() == 100000);
+    REQUIRE(index.get(5) == location_for(5));
+
+    index.set(99999, location_for(99999));
+    REQUIRE(index.get(99999) == location_for(99999));
+
+    index.clear();
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.get_noexcept(5) == osmium::Location{});
+}
+
+TEST_CASE("DenseConcurrentArray: set from several threads") {
+    const osmium::unsigned_object_id_type max_id = 200000;
+    const unsigned int num_threads = 4;
+
+    index_type index{max_id};
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&index, t]() {
+            for (osmium::unsigned_object_id_type id = t + 1; id <= max_id; id += num_threads) {
+                index.set(id, location_for(id));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(index.get_noexcept(0) == osmium::Location{});
+    for (osmium::unsigned_object_id_type id = 1; id <= max_id; ++id) {
+        REQUIRE(index.get(id) == location_for(id));
+    }
+
+    std::vector<osmium::unsigned_object_id_type> ids{max_id, 1, 0, 77, max_id + 1};
+    std::vector<osmium::Location> locations(ids.size());
+    index.get_noexcept_bulk(ids.data(), ids.size(), locations.data());
+    REQUIRE(locations[0] == location_for(max_id));
+    REQUIRE(locations[1] == location_for(1));
+    REQUIRE(locations[2] == osmium::Location{});
+    REQUIRE(locations[3] == location_for(77));
+    REQUIRE(locations[4] == osmium::Location{});
+}
+
+TEST_CASE("DenseConcurrentArray: create from factory") {
+    const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
+
+    REQUIRE(map_factory.has_map_type("dense_concurrent_array"));
+
+    const auto index = map_factory.create_map("dense_concurrent_array,1000");
+    REQUIRE(index->size() == 1001);
+    index->set(1000, location_for(1000));
+    REQUIRE(index->get(1000) == location_for(1000));
+
+    REQUIRE_THROWS_AS(map_factory.create_map("dense_concurrent_array,foo"), osmium::map_factory_error);
+}
@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/map/dense_paged_array.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using index_type = osmium::index::map::DensePagedArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id % 1000000), static_cast<int32_t>(id % 7)};
+}
+
+static void fill(index_type& index) {
+    // Two ranges far apart with high Ids
+    for (osmium::unsigned_object_id_type id = 5000000000ULL; id < 5000100000ULL; id += 3) {
+        index.set(id, location_for(id));
+    }
+    for (osmium::unsigned_object_id_type id = 9000000000ULL; id < 9000001000ULL; ++id) {
+        index.set(id, location_for(id));
+    }
+}
+
+static void check(const index_type& index) {
+    REQUIRE(index.size() == 33334 + 1000);
+    REQUIRE(index.num_pages() <= 5);
+
+    REQUIRE(index.get(5000000000ULL) == location_for(5000000000ULL));
+    REQUIRE(index.get(5000000003ULL) == location_for(5000000003ULL));
+    REQUIRE(index.get_noexcept(5000000001ULL) == osmium::Location{});
+    REQUIRE_THROWS_AS(index.get(5000000001ULL), osmium::not_found);
+    REQUIRE(index.get(9000000999ULL) == location_for(9000000999ULL));
+    REQUIRE(index.get_noexcept(9000001000ULL) == osmium::Location{});
+    REQUIRE(index.get_noexcept(1) == osmium::Location{});
+    REQUIRE(index.get_noexcept(1ULL << 50U) == osmium::Location{});
+
+    const std::vector<osmium::unsigned_object_id_type> ids{5000000000ULL, 17, 9000000005ULL, 5000000002ULL};
+    std::vector<osmium::Location> locations(ids.size());
+    index.get_noexcept_bulk(ids.data(), ids.size(), locations.data());
+    REQUIRE(locations[0] == location_for(ids[0]));
+    REQUIRE(locations[1] == osmium::Location{});
+    REQUIRE(locations[2] == location_for(ids[2]));
+    REQUIRE(locations[3] == osmium::Location{});
+}
+
+TEST_CASE("DensePagedArray in memory") {
+    index_type index;
+    REQUIRE(index.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(index.num_pages() == 0);
+
+    fill(index);
+    check(index);
+
+    // Memory used is proportional to the Id ranges used, not the max Id.
+    REQUIRE(index.used_memory() < 20UL * 1024UL * 1024UL);
+
+    index.clear();
+    REQUIRE(index.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(index.get_noexcept(5000000000ULL) == osmium::Location{});
+}
+
+TEST_CASE("DensePagedArray allocates pages in chunks") {
+    index_type index;
+    for (osmium::unsigned_object_id_type page = 0; page < 3000; ++page) {
+        const osmium::unsigned_object_id_type id = page * index_type::page_ids * 2 + page;
+        index.set(id, location_for(id));
+    }
+
+    REQUIRE(index.num_pages() == 3000);
+    REQUIRE(index.num_chunks() == 13);
+
+    for (osmium::unsigned_object_id_type page = 0; page < 3000; ++page) {
+        const osmium::unsigned_object_id_type id = page * index_type::page_ids * 2 + page;
+        REQUIRE(index.get(id) == location_for(id));
+        REQUIRE(index.get_noexcept(id + 1) == osmium::Location{});
+    }
+}
+
+TEST_CASE("DensePagedArray stores empty value and overwrites values") {
+    index_type index;
+    index.set(10, osmium::Location{});
+    index.set(11, osmium::Location{1, 2});
+    index.set(11, osmium::Location{3, 4});
+    REQUIRE(index.size() == 2);
+    REQUIRE(index.get(10) == osmium::Location{});
+    REQUIRE(index.get(11) == (osmium::Location{3, 4}));
+}
+
+TEST_CASE("DensePagedArray with file backing") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    index_type index{fd};
+    fill(index);
+    check(index);
+
+    REQUIRE(osmium::file_size(fd) <= index.used_memory());
+    REQUIRE(osmium::file_size(fd) >= index.num_pages() * index_type::page_ids * sizeof(osmium::Location));
+
+    osmium::io::detail::reliable_close(fd);
+}
+
+TEST_CASE("DensePagedArray dump as list") {
+    index_type index;
+    index.set(70000, location_for(70000));
+    index.set(3, location_for(3));
+
+    const int fd = osmium::detail::create_tmp_file();
+    index.dump_as_list(fd);
+    REQUIRE(osmium::file_size(fd) == 2 * sizeof(std::pair<osmium::unsigned_object_id_type, osmium::Location>));
+    osmium::io::detail::reliable_close(fd);
+}
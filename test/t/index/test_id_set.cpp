@@ -3,6 +3,9 @@
 #include <osmium/index/id_set.hpp>
 #include <osmium/osm/types.hpp>
 
+#include <algorithm>
+#include <vector>
+
 TEST_CASE("Basic functionality of IdSetDense") {
     osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
 
@@ -131,6 +134,72 @@ TEST_CASE("Large gap") {
     REQUIRE_FALSE(s.get(1U << 29U));
 }
 
+TEST_CASE("Set range of Ids in IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> s;
+
+    const std::vector<osmium::unsigned_object_id_type> ids{3, 5, 5, 17, 1ULL << 30U, (1ULL << 30U) + 1, 1ULL << 33U};
+    s.set(ids.cbegin(), ids.cend());
+    REQUIRE(s.size() == 6);
+    REQUIRE(std::equal(s.begin(), s.end(), std::vector<osmium::unsigned_object_id_type>{3, 5, 17, 1ULL << 30U, (1ULL << 30U) + 1, 1ULL << 33U}.begin()));
+
+    const std::vector<osmium::unsigned_object_id_type> more{17, 2, 1ULL << 31U};
+    s.set(more.cbegin(), more.cend());
+    REQUIRE(s.size() == 8);
+    REQUIRE(s.get(2));
+    REQUIRE(s.get(1ULL << 31U));
+}
+
+TEST_CASE("Set operations on IdSetDense") {
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> a;
+    osmium::index::IdSetDense<osmium::unsigned_object_id_type> b;
+
+    // a: 10, 20, 30, 1<<33
+    // b: 20, 25, 30, 1<<34
+    a.set(10);
+    a.set(20);
+    a.set(30);
+    a.set(1ULL << 33U);
+    b.set(20);
+    b.set(25);
+    b.set(30);
+    b.set(1ULL << 34U);
+
+    REQUIRE(a.intersection_size(b) == 2);
+    REQUIRE(b.intersection_size(a) == 2);
+
+    SECTION("union") {
+        a.union_with(b);
+        REQUIRE(a.size() == 6);
+        REQUIRE(std::equal(a.begin(), a.end(), std::vector<osmium::unsigned_object_id_type>{10, 20, 25, 30, 1ULL << 33U, 1ULL << 34U}.begin()));
+    }
+
+    SECTION("intersection") {
+        a.intersect_with(b);
+        REQUIRE(a.size() == 2);
+        REQUIRE(std::equal(a.begin(), a.end(), std::vector<osmium::unsigned_object_id_type>{20, 30}.begin()));
+        REQUIRE_FALSE(a.get(1ULL << 33U));
+    }
+
+    SECTION("difference") {
+        a.subtract(b);
+        REQUIRE(a.size() == 2);
+        REQUIRE(std::equal(a.begin(), a.end(), std::vector<osmium::unsigned_object_id_type>{10, 1ULL << 33U}.begin()));
+        b.subtract(b);
+        REQUIRE(b.empty());
+    }
+
+    SECTION("with empty set") {
+        const osmium::index::IdSetDense<osmium::unsigned_object_id_type> empty;
+        a.union_with(empty);
+        REQUIRE(a.size() == 4);
+        a.subtract(empty);
+        REQUIRE(a.size() == 4);
+        REQUIRE(a.intersection_size(empty) == 0);
+        a.intersect_with(empty);
+        REQUIRE(a.empty());
+    }
+}
+
 TEST_CASE("Basic functionality of IdSetSmall") {
     osmium::index::IdSetSmall<osmium::unsigned_object_id_type> s;
 
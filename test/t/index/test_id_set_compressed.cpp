@@ -0,0 +1,205 @@
+#include "catch.hpp"
+
+#include <osmium/index/id_set_compressed.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+using id_set_type = osmium::index::IdSetCompressed<osmium::unsigned_object_id_type>;
+
+static void check_same(const id_set_type& s, const std::set<osmium::unsigned_object_id_type>& expected) {
+    REQUIRE(s.size() == expected.size());
+    REQUIRE(s.empty() == expected.empty());
+    REQUIRE(std::distance(s.begin(), s.end()) == static_cast<std::ptrdiff_t>(expected.size()));
+    REQUIRE(std::equal(s.begin(), s.end(), expected.begin()));
+    for (const auto id : expected) {
+        REQUIRE(s.get(id));
+    }
+}
+
+TEST_CASE("Basic functionality of IdSetCompressed") {
+    id_set_type s;
+
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+    REQUIRE(s.empty());
+    REQUIRE(s.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(s.begin() == s.end());
+
+    s.set(17);
+    REQUIRE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+    REQUIRE_FALSE(s.empty());
+    REQUIRE(s.size() == 1);
+
+    s.set(28);
+    s.set(17);
+    REQUIRE(s.get(17));
+    REQUIRE(s.get(28));
+    REQUIRE(s.size() == 2);
+
+    REQUIRE_FALSE(s.check_and_set(17));
+    REQUIRE(s.check_and_set(1000000000));
+    REQUIRE(s.get(1000000000));
+    REQUIRE(s.size() == 3);
+
+    s.unset(17);
+    s.unset(99);
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.size() == 2);
+
+    check_same(s, {28, 1000000000});
+
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.get(28));
+}
+
+TEST_CASE("IdSetCompressed with all container types") {
+    id_set_type s;
+    std::set<osmium::unsigned_object_id_type> expected;
+
+    // sparse ids in many containers, set out of order
+    for (osmium::unsigned_object_id_type id = 5000000000ULL; id > 7777777; id -= 7777777) {
+        s.set(id);
+        expected.insert(id);
+    }
+
+    // dense ids in a single container (becomes a bitmap)
+    for (osmium::unsigned_object_id_type id = 1ULL << 20U; id < (1ULL << 20U) + 30000; id += 3) {
+        s.set(id);
+        expected.insert(id);
+    }
+
+    // consecutive ids (becomes runs after optimize)
+    for (osmium::unsigned_object_id_type id = 3ULL << 20U; id < (3ULL << 20U) + 20000; ++id) {
+        s.set(id);
+        expected.insert(id);
+    }
+
+    check_same(s, expected);
+    REQUIRE_FALSE(s.get((1ULL << 20U) + 1));
+
+    const auto memory = s.used_memory();
+    s.optimize();
+    REQUIRE(s.used_memory() < memory);
+    check_same(s, expected);
+    REQUIRE_FALSE(s.get((3ULL << 20U) + 20000));
+    REQUIRE_FALSE(s.get((3ULL << 20U) - 1));
+
+    // change after optimize
+    s.set((3ULL << 20U) + 30000);
+    expected.insert((3ULL << 20U) + 30000);
+    s.unset((3ULL << 20U) + 100);
+    expected.erase((3ULL << 20U) + 100);
+    s.unset((1ULL << 20U) + 3);
+    expected.erase((1ULL << 20U) + 3);
+    check_same(s, expected);
+}
+
+TEST_CASE("IdSetCompressed union and intersection") {
+    id_set_type a;
+    id_set_type b;
+    std::set<osmium::unsigned_object_id_type> ea;
+    std::set<osmium::unsigned_object_id_type> eb;
+
+    for (osmium::unsigned_object_id_type id = 0; id < 300000; id += 2) {
+        a.set(id);
+        ea.insert(id);
+    }
+    for (osmium::unsigned_object_id_type id = 0; id < 600000; id += 3) {
+        b.set(id);
+        eb.insert(id);
+    }
+    for (osmium::unsigned_object_id_type id = 100000000; id < 100000100; ++id) {
+        b.set(id);
+        eb.insert(id);
+    }
+
+    SECTION("union") {
+        std::set<osmium::unsigned_object_id_type> expected{ea};
+        expected.insert(eb.begin(), eb.end());
+        a.union_with(b);
+        check_same(a, expected);
+    }
+
+    SECTION("union with optimized") {
+        std::set<osmium::unsigned_object_id_type> expected{ea};
+        expected.insert(eb.begin(), eb.end());
+        b.optimize();
+        a.union_with(b);
+        check_same(a, expected);
+    }
+
+    SECTION("intersection") {
+        std::set<osmium::unsigned_object_id_type> expected;
+        std::set_intersection(ea.begin(), ea.end(), eb.begin(), eb.end(), std::inserter(expected, expected.end()));
+        a.intersect_with(b);
+        check_same(a, expected);
+    }
+
+    SECTION("intersection with optimized") {
+        std::set<osmium::unsigned_object_id_type> expected;
+        std::set_intersection(eb.begin(), eb.end(), ea.begin(), ea.end(), std::inserter(expected, expected.end()));
+        b.optimize();
+        b.intersect_with(a);
+        check_same(b, expected);
+    }
+
+    SECTION("intersection with empty set") {
+        a.intersect_with(id_set_type{});
+        REQUIRE(a.empty());
+        REQUIRE(a.begin() == a.end());
+    }
+}
+
+TEST_CASE("IdSetCompressed intersection of bitmap with runs") {
+    id_set_type a;
+    id_set_type b;
+    std::set<osmium::unsigned_object_id_type> expected;
+
+    for (osmium::unsigned_object_id_type id = 0; id < 60000; ++id) {
+        a.set(id);
+        b.set(id);
+        expected.insert(id);
+    }
+    b.optimize();
+
+    const auto memory = a.used_memory();
+    a.intersect_with(b);
+    check_same(a, expected);
+    REQUIRE(a.used_memory() <= memory);
+
+    b.intersect_with(a);
+    check_same(b, expected);
+}
+
+TEST_CASE("IdSetCompressed union and intersection with itself") {
+    id_set_type s;
+    std::set<osmium::unsigned_object_id_type> expected;
+
+    for (osmium::unsigned_object_id_type id = 0; id < 30000; id += 3) {
+        s.set(id);
+        expected.insert(id);
+    }
+    for (osmium::unsigned_object_id_type id = 1ULL << 20U; id < (1ULL << 20U) + 20000; ++id) {
+        s.set(id);
+        expected.insert(id);
+    }
+    s.set(5000000000ULL);
+    expected.insert(5000000000ULL);
+    s.optimize();
+
+    SECTION("union") {
+        s.union_with(s);
+        check_same(s, expected);
+    }
+
+    SECTION("intersection") {
+        s.intersect_with(s);
+        check_same(s, expected);
+    }
+}
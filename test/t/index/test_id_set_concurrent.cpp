@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include <osmium/index/id_set_concurrent.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Basic functionality of ConcurrentIdSetDense") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s;
+
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+    REQUIRE(s.empty());
+    REQUIRE(s.size() == 0); // NOLINT(readability-container-size-empty)
+
+    s.set(17);
+    REQUIRE(s.get(17));
+    REQUIRE_FALSE(s.get(28));
+    REQUIRE_FALSE(s.empty());
+    REQUIRE(s.size() == 1);
+
+    s.set(28);
+    s.set(17);
+    REQUIRE(s.size() == 2);
+
+    REQUIRE_FALSE(s.check_and_set(17));
+    REQUIRE(s.check_and_set(1ULL << 33U));
+    REQUIRE(s.get(1ULL << 33U));
+    REQUIRE(s.size() == 3);
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    s.for_each([&ids](osmium::unsigned_object_id_type id) {
+        ids.push_back(id);
+    });
+    REQUIRE(ids == std::vector<osmium::unsigned_object_id_type>{17, 28, 1ULL << 33U});
+
+    s.unset(17);
+    s.unset(1ULL << 34U);
+    REQUIRE_FALSE(s.get(17));
+    REQUIRE(s.size() == 2);
+
+    s.clear();
+    REQUIRE(s.empty());
+    REQUIRE_FALSE(s.get(28));
+}
+
+TEST_CASE("ConcurrentIdSetDense with maximum Id") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s{1000};
+
+    s.set(1000);
+    REQUIRE(s.get(1000));
+    REQUIRE_FALSE(s.get(1ULL << 40U));
+    REQUIRE_THROWS_AS(s.set(1ULL << 40U), std::out_of_range);
+}
+
+TEST_CASE("Set Ids in ConcurrentIdSetDense from several threads") {
+    osmium::index::ConcurrentIdSetDense<osmium::unsigned_object_id_type> s;
+    const unsigned int num_threads = 4;
+    const osmium::unsigned_object_id_type max_id = 100000000;
+
+    // All threads set the same Ids, only one of them should see each one
+    // as new.
+    std::atomic<osmium::unsigned_object_id_type> added{0};
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&s, &added, max_id]() {
+            osmium::unsigned_object_id_type count = 0;
+            for (osmium::unsigned_object_id_type id = 3; id < max_id; id += 17) {
+                if (s.check_and_set(id)) {
+                    ++count;
+                }
+            }
+            added += count;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const osmium::unsigned_object_id_type expected = (max_id - 3 + 16) / 17;
+    REQUIRE(added == expected);
+    REQUIRE(s.size() == expected);
+    REQUIRE(s.get(3));
+    REQUIRE(s.get(20));
+    REQUIRE_FALSE(s.get(21));
+}
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+
+#include <osmium/index/id_set_parallel.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <vector>
+
+using id_set_type = osmium::index::IdSetDense<osmium::unsigned_object_id_type>;
+
+static void fill(id_set_type& s, osmium::unsigned_object_id_type start, osmium::unsigned_object_id_type step) {
+    std::vector<osmium::unsigned_object_id_type> ids;
+    for (osmium::unsigned_object_id_type id = start; id < 200000000; id += step) {
+        ids.push_back(id);
+    }
+    s.set(ids.cbegin(), ids.cend());
+}
+
+TEST_CASE("Parallel set operations on IdSetDense") {
+    osmium::thread::Pool pool{4};
+
+    id_set_type a;
+    id_set_type b;
+    fill(a, 0, 1000);
+    fill(b, 100000000, 1500);
+
+    id_set_type expected{a};
+
+    SECTION("union") {
+        expected.union_with(b);
+        osmium::index::parallel_union_with(a, b, pool);
+        REQUIRE(a.size() == expected.size());
+        REQUIRE(a.intersection_size(expected) == expected.size());
+    }
+
+    SECTION("intersection") {
+        REQUIRE(osmium::index::parallel_intersection_size(a, b, pool) == a.intersection_size(b));
+        expected.intersect_with(b);
+        osmium::index::parallel_intersect_with(a, b, pool);
+        REQUIRE(a.size() == expected.size());
+        REQUIRE(a.size() == b.intersection_size(a));
+        REQUIRE(a.intersection_size(expected) == expected.size());
+    }
+
+    SECTION("difference") {
+        expected.subtract(b);
+        osmium::index::parallel_subtract(a, b, pool);
+        REQUIRE(a.size() == expected.size());
+        REQUIRE(a.intersection_size(b) == 0);
+        REQUIRE(a.intersection_size(expected) == expected.size());
+    }
+}
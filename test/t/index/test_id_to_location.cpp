@@ -1,12 +1,17 @@
 #include "catch.hpp"
 
+#include <osmium/index/map/dense_concurrent_array.hpp>
 #include <osmium/index/map/dense_file_array.hpp>
 #include <osmium/index/map/dense_mem_array.hpp>
 #include <osmium/index/map/dense_mmap_array.hpp>
+#include <osmium/index/map/dense_paged_array.hpp>
 #include <osmium/index/map/dummy.hpp>
 #include <osmium/index/map/flex_mem.hpp>
 #include <osmium/index/map/sparse_file_array.hpp>
 #include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_compressed.hpp>
+#include <osmium/index/map/sparse_mem_hash.hpp>
+#include <osmium/index/map/sparse_mem_interpolated.hpp>
 #include <osmium/index/map/sparse_mem_map.hpp>
 #include <osmium/index/map/sparse_mmap_array.hpp>
 #include <osmium/index/node_locations_map.hpp>
@@ -15,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 static_assert(osmium::index::empty_value<osmium::Location>() == osmium::Location{}, "Empty value for location is wrong");
@@ -118,6 +124,16 @@ TEST_CASE("Map Id to location: DenseMemArray") {
     test_func_real<index_type>(index2);
 }
 
+TEST_CASE("Map Id to location: DenseConcurrentArray") {
+    using index_type = osmium::index::map::DenseConcurrentArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index1{1000};
+    test_func_all<index_type>(index1);
+
+    index_type index2{1000};
+    test_func_real<index_type>(index2);
+}
+
 #ifdef __linux__
 TEST_CASE("Map Id to location: DenseMmapArray") {
     using index_type = osmium::index::map::DenseMmapArray<osmium::unsigned_object_id_type, osmium::Location>;
@@ -142,6 +158,22 @@ TEST_CASE("Map Id to location: DenseFileArray") {
     test_func_real<index_type>(index2);
 }
 
+TEST_CASE("Map Id to location: DensePagedArray") {
+    using index_type = osmium::index::map::DensePagedArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index1;
+
+    REQUIRE(0 == index1.size());
+    REQUIRE(0 == index1.used_memory());
+
+    test_func_all<index_type>(index1);
+
+    REQUIRE(2 == index1.size());
+
+    index_type index2;
+    test_func_real<index_type>(index2);
+}
+
 TEST_CASE("Map Id to location: SparseMemMap") {
     using index_type = osmium::index::map::SparseMemMap<osmium::unsigned_object_id_type, osmium::Location>;
 
@@ -168,6 +200,38 @@ TEST_CASE("Map Id to location: SparseMemArray") {
     test_func_real<index_type>(index2);
 }
 
+TEST_CASE("Map Id to location: SparseMemHash") {
+    using index_type = osmium::index::map::SparseMemHash<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index1;
+
+    REQUIRE(0 == index1.size());
+    REQUIRE(0 == index1.used_memory());
+
+    test_func_all<index_type>(index1);
+
+    REQUIRE(2 == index1.size());
+
+    index_type index2;
+    test_func_real<index_type>(index2);
+}
+
+TEST_CASE("Map Id to location: SparseMemInterpolated") {
+    using index_type = osmium::index::map::SparseMemInterpolated<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index1;
+
+    REQUIRE(0 == index1.size());
+    REQUIRE(0 == index1.used_memory());
+
+    test_func_all<index_type>(index1);
+
+    REQUIRE(2 == index1.size());
+
+    index_type index2;
+    test_func_real<index_type>(index2);
+}
+
 #ifdef __linux__
 TEST_CASE("Map Id to location: SparseMmapArray") {
     using index_type = osmium::index::map::SparseMmapArray<osmium::unsigned_object_id_type, osmium::Location>;
@@ -234,6 +298,59 @@ TEST_CASE("Map Id to location: FlexMem switch") {
     REQUIRE(index.get_noexcept(2000000000) == osmium::Location{});
 }
 
+TEST_CASE("Map Id to location: FlexMem with custom switch thresholds") {
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+    index_type index{false, 10, 2};
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 9; ++id) {
+        index.set(id * 2, osmium::Location{1, 1});
+    }
+    REQUIRE_FALSE(index.is_dense());
+
+    index.set(19, osmium::Location{2, 2});
+    REQUIRE(index.is_dense());
+    REQUIRE(index.get(18) == osmium::Location(1, 1));
+    REQUIRE(index.get(19) == osmium::Location(2, 2));
+}
+
+TEST_CASE("Map Id to location: Memory estimates") {
+    using id_type = osmium::unsigned_object_id_type;
+    const auto& map_factory = osmium::index::MapFactory<id_type, osmium::Location>::instance();
+
+    REQUIRE(map_factory.estimate_memory("dense_mem_array", 10, 999) == 1000 * sizeof(osmium::Location));
+    REQUIRE(map_factory.estimate_memory("sparse_mem_array", 10, 999) == 10 * sizeof(std::pair<id_type, osmium::Location>));
+    REQUIRE(map_factory.estimate_memory("sparse_mem_map", 10, 999) > map_factory.estimate_memory("sparse_mem_array", 10, 999));
+    REQUIRE(map_factory.estimate_memory("sparse_mem_hash", 1000, 999) >= 1000 * (sizeof(id_type) + sizeof(osmium::Location)));
+    REQUIRE(map_factory.estimate_memory("sparse_file_array", 10, 999) == 0);
+    REQUIRE_THROWS_AS(map_factory.estimate_memory("does not exist", 10, 999), osmium::map_factory_error);
+
+    // FlexMem estimate is sparse or dense depending on the density
+    REQUIRE(map_factory.estimate_memory("flex_mem", 100000000, 150000000) <
+            map_factory.estimate_memory("sparse_mem_array", 100000000, 150000000));
+    REQUIRE(map_factory.estimate_memory("flex_mem", 1000, 1000000000) <
+            map_factory.estimate_memory("dense_mem_array", 1000, 1000000000));
+}
+
+TEST_CASE("Map Id to location: Select map") {
+    const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
+
+    const std::vector<std::string> candidates = {"dense_mem_array", "sparse_mem_array", "sparse_file_array"};
+
+    // few entries with large ids: sparse is better
+    REQUIRE(map_factory.select_map(1000, 1000000000, candidates) == "sparse_mem_array");
+
+    // almost all ids used: dense is better
+    REQUIRE(map_factory.select_map(900000, 1000000, candidates) == "dense_mem_array");
+
+    REQUIRE_THROWS_AS(map_factory.select_map(1000, 1000000, {"sparse_file_array"}), osmium::map_factory_error);
+
+    // the selected map can be created
+    const auto name = map_factory.select_map(1000, 1000000000);
+    REQUIRE(map_factory.estimate_memory(name, 1000, 1000000000) > 0);
+    REQUIRE(map_factory.create_map(name));
+}
+
 TEST_CASE("Map Id to location: Dynamic map choice") {
     using map_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
     const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
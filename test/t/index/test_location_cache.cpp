@@ -0,0 +1,206 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/location_cache.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <cstdint>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+
+using cache_type = osmium::index::map::LocationCache<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id * 3), static_cast<int32_t>(id)};
+}
+
+template <typename TIndex>
+static void fill(TIndex& index) {
+    for (osmium::unsigned_object_id_type id = 10; id <= 1000; id += 10) {
+        index.set(id, location_for(id));
+    }
+}
+
+static void check_cache(const cache_type& cache) {
+    REQUIRE(cache.verify());
+    REQUIRE(cache.timestamp() == osmium::Timestamp{"2023-10-01T12:00:00Z"});
+    REQUIRE(cache.header().max_id == 1000);
+
+    REQUIRE(cache.get(10) == location_for(10));
+    REQUIRE(cache.get(550) == location_for(550));
+    REQUIRE(cache.get(1000) == location_for(1000));
+    REQUIRE_THROWS_AS(cache.get(0), osmium::not_found);
+    REQUIRE_THROWS_AS(cache.get(11), osmium::not_found);
+    REQUIRE_THROWS_AS(cache.get(5000), osmium::not_found);
+    REQUIRE(cache.get_noexcept(11) == osmium::Location{});
+
+    osmium::unsigned_object_id_type count = 0;
+    cache.for_each([&count](osmium::unsigned_object_id_type id, const osmium::Location& location) {
+        ++count;
+        REQUIRE(id == count * 10);
+        REQUIRE(location == location_for(id));
+    });
+    REQUIRE(count == 100);
+
+    const std::vector<osmium::unsigned_object_id_type> ids{10, 15, 20, 990, 5000, 30};
+    std::vector<osmium::Location> locations(ids.size());
+    cache.get_noexcept_bulk(ids.data(), ids.size(), locations.data());
+    REQUIRE(locations[0] == location_for(10));
+    REQUIRE(locations[1] == osmium::Location{});
+    REQUIRE(locations[2] == location_for(20));
+    REQUIRE(locations[3] == location_for(990));
+    REQUIRE(locations[4] == osmium::Location{});
+    REQUIRE(locations[5] == location_for(30));
+}
+
+TEST_CASE("Location cache: dense") {
+    const int fd = osmium::detail::create_tmp_file();
+    const osmium::Timestamp timestamp{"2023-10-01T12:00:00Z"};
+
+    osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    fill(index);
+    const auto header = osmium::index::map::write_location_cache(fd, index, osmium::index::map::location_cache_type::dense, timestamp);
+
+    REQUIRE(header.min_id == 0);
+    REQUIRE(header.count == index.size());
+    REQUIRE(osmium::file_size(fd) == sizeof(osmium::index::map::location_cache_header) + index.size() * sizeof(osmium::Location));
+
+    const cache_type cache{fd};
+    REQUIRE(cache.type() == osmium::index::map::location_cache_type::dense);
+    REQUIRE(cache.size() == index.size());
+    check_cache(cache);
+
+    REQUIRE_THROWS_AS(cache_type{fd}.set(1, osmium::Location{}), osmium::location_cache_error);
+}
+
+TEST_CASE("Location cache: sparse") {
+    const int fd = osmium::detail::create_tmp_file();
+    const osmium::Timestamp timestamp{"2023-10-01T12:00:00Z"};
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    fill(index);
+    const auto header = osmium::index::map::write_location_cache(fd, index, osmium::index::map::location_cache_type::sparse, timestamp);
+
+    REQUIRE(header.min_id == 10);
+    REQUIRE(header.count == 100);
+
+    const cache_type cache{fd};
+    REQUIRE(cache.type() == osmium::index::map::location_cache_type::sparse);
+    REQUIRE(cache.size() == 100);
+    check_cache(cache);
+}
+
+TEST_CASE("Location cache: written directly with LocationCacheWriter") {
+    using writer_type = osmium::index::map::LocationCacheWriter<osmium::unsigned_object_id_type, osmium::Location>;
+    const int fd = osmium::detail::create_tmp_file();
+    const osmium::Timestamp timestamp{"2023-10-01T12:00:00Z"};
+
+    SECTION("dense") {
+        writer_type writer{fd, osmium::index::map::location_cache_type::dense, timestamp};
+        fill(writer);
+        const auto header = writer.close();
+        REQUIRE(header.min_id == 0);
+        REQUIRE(header.count == 1001);
+        REQUIRE(osmium::file_size(fd) == sizeof(osmium::index::map::location_cache_header) + 1001 * sizeof(osmium::Location));
+
+        const cache_type cache{fd};
+        REQUIRE(cache.type() == osmium::index::map::location_cache_type::dense);
+        check_cache(cache);
+    }
+
+    SECTION("sparse") {
+        writer_type writer{fd, osmium::index::map::location_cache_type::sparse, timestamp};
+        fill(writer);
+        const auto header = writer.close();
+        REQUIRE(header.min_id == 10);
+        REQUIRE(header.count == 100);
+        REQUIRE(writer.close().checksum == header.checksum);
+
+        const cache_type cache{fd};
+        REQUIRE(cache.type() == osmium::index::map::location_cache_type::sparse);
+        check_cache(cache);
+    }
+
+    SECTION("unsorted ids") {
+        writer_type writer{fd, osmium::index::map::location_cache_type::sparse, timestamp};
+        writer.set(10, location_for(10));
+        REQUIRE_THROWS_AS(writer.set(10, location_for(10)), osmium::location_cache_error);
+        REQUIRE_THROWS_AS(writer.set(5, location_for(5)), osmium::location_cache_error);
+    }
+}
+
+TEST_CASE("Location cache: empty index") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    osmium::index::map::write_location_cache(fd, index, osmium::index::map::location_cache_type::sparse);
+
+    const cache_type cache{fd};
+    REQUIRE(cache.verify());
+    REQUIRE(cache.size() == 0);
+    REQUIRE(cache.get_noexcept(17) == osmium::Location{});
+}
+
+TEST_CASE("Location cache: open by file name") {
+    const std::string filename{"test_location_cache.tmp"};
+    const int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666); // NOLINT(hicpp-signed-bitwise)
+    REQUIRE(fd >= 0);
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    fill(index);
+    osmium::index::map::write_location_cache(fd, index, osmium::index::map::location_cache_type::sparse, osmium::Timestamp{"2023-10-01T12:00:00Z"});
+    osmium::io::detail::reliable_close(fd);
+
+    {
+        const cache_type cache{filename};
+        check_cache(cache);
+    }
+
+    REQUIRE(0 == ::unlink(filename.c_str()));
+
+    REQUIRE_THROWS_AS(cache_type{filename}, std::system_error);
+}
+
+TEST_CASE("Location cache: detect broken files") {
+    const int fd = osmium::detail::create_tmp_file();
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    fill(index);
+    osmium::index::map::write_location_cache(fd, index, osmium::index::map::location_cache_type::sparse);
+    const std::size_t size = osmium::file_size(fd);
+
+    SECTION("corrupted data") {
+        osmium::file_seek(fd, size - 3);
+        osmium::io::detail::reliable_write(fd, "xyz", 3);
+        const cache_type cache{fd};
+        REQUIRE_FALSE(cache.verify());
+    }
+
+    SECTION("truncated file") {
+        osmium::resize_file(fd, size - 16);
+        REQUIRE_THROWS_AS(cache_type{fd}, osmium::location_cache_error);
+    }
+
+    SECTION("wrong magic") {
+        osmium::file_seek(fd, 0);
+        osmium::io::detail::reliable_write(fd, "XXX", 3);
+        REQUIRE_THROWS_WITH(cache_type{fd}, "not a location cache file");
+    }
+
+    SECTION("too small") {
+        osmium::resize_file(fd, 10);
+        REQUIRE_THROWS_AS(cache_type{fd}, osmium::location_cache_error);
+    }
+
+    SECTION("wrong value size") {
+        using other_cache_type = osmium::index::map::LocationCache<osmium::unsigned_object_id_type, uint32_t>;
+        REQUIRE_THROWS_AS(other_cache_type{fd}, osmium::location_cache_error);
+    }
+}
@@ -0,0 +1,45 @@
+#include "catch.hpp"
+
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+// Make sure all maps can be used together in one compilation unit.
+#define OSMIUM_WANT_NODE_LOCATION_MAPS
+#include <osmium/index/map/all.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST_CASE("All map types are available through the factory") {
+    using map_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
+    const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
+
+    const std::vector<std::string> names = {
+        "dense_concurrent_array",
+        "dense_file_array",
+        "dense_mem_array",
+        "dense_mmap_array",
+        "dense_paged_array",
+        "flex_mem",
+        "sparse_file_array",
+        "sparse_mem_array",
+        "sparse_mem_compressed",
+        "sparse_mem_hash",
+        "sparse_mem_interpolated",
+        "sparse_mem_map",
+        "sparse_mmap_array"
+    };
+
+    for (const auto& name : names) {
+        INFO(name);
+        REQUIRE(map_factory.has_map_type(name));
+
+        std::unique_ptr<map_type> index = map_factory.create_map(name);
+        index->reserve(100);
+        index->set(17, osmium::Location{1.0, 2.0});
+        index->sort();
+        REQUIRE(index->get(17) == osmium::Location(1.0, 2.0));
+        REQUIRE(index->get_noexcept(18) == osmium::Location{});
+    }
+}
@@ -0,0 +1,88 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_compressed.hpp>
+#include <osmium/index/map/sparse_mem_map.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using map_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id), static_cast<int32_t>(id * 2)};
+}
+
+static void fill(map_type& index) {
+    for (osmium::unsigned_object_id_type id = 2; id < 2000; id += 2) {
+        index.set(id, location_for(id));
+    }
+    index.sort();
+}
+
+static void check_bulk(const map_type& index, const std::vector<osmium::unsigned_object_id_type>& ids) {
+    std::vector<osmium::Location> locations(ids.size());
+    index.get_noexcept_bulk(ids.data(), ids.size(), locations.data());
+
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(locations[i] == index.get_noexcept(ids[i]));
+        if (ids[i] > 0 && ids[i] < 2000 && ids[i] % 2 == 0) {
+            REQUIRE(locations[i] == location_for(ids[i]));
+        } else {
+            REQUIRE(locations[i] == osmium::Location{});
+        }
+    }
+}
+
+static void test_bulk(map_type& index) {
+    check_bulk(index, {});
+
+    fill(index);
+
+    check_bulk(index, {});
+    check_bulk(index, {4});
+    check_bulk(index, {3});
+    check_bulk(index, {0, 1, 2, 4, 4, 5, 100, 102, 1000, 1998, 1999, 2000, 5000});
+    check_bulk(index, {5000, 1998, 4, 17, 4, 2, 0, 222, 3});
+
+    std::vector<osmium::unsigned_object_id_type> ids;
+    for (osmium::unsigned_object_id_type id = 0; id < 2100; id += 3) {
+        ids.push_back(id);
+    }
+    check_bulk(index, ids);
+}
+
+TEST_CASE("Bulk get: DenseMemArray") {
+    osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_bulk(index);
+}
+
+TEST_CASE("Bulk get: SparseMemArray") {
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_bulk(index);
+}
+
+TEST_CASE("Bulk get: SparseMemMap") {
+    osmium::index::map::SparseMemMap<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_bulk(index);
+}
+
+TEST_CASE("Bulk get: SparseMemCompressed") {
+    osmium::index::map::SparseMemCompressed<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_bulk(index);
+}
+
+TEST_CASE("Bulk get: FlexMem sparse") {
+    osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location> index;
+    test_bulk(index);
+}
+
+TEST_CASE("Bulk get: FlexMem dense") {
+    osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location> index{true};
+    test_bulk(index);
+}
+
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/mapped_relations_map.hpp>
+#include <osmium/index/relations_map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+
+#include <type_traits>
+#include <vector>
+
+static_assert(!std::is_default_constructible<osmium::index::MappedRelationsMapIndex>::value, "MappedRelationsMapIndex should not be default constructible");
+static_assert(!std::is_copy_constructible<osmium::index::MappedRelationsMapIndex>::value, "MappedRelationsMapIndex should not be copy constructible");
+
+using ids_type = std::vector<osmium::unsigned_object_id_type>;
+
+template <typename TIndex>
+static ids_type get(const TIndex& index, osmium::unsigned_object_id_type id) {
+    ids_type ids;
+    index.for_each(id, [&ids](osmium::unsigned_object_id_type rid) {
+        ids.push_back(rid);
+    });
+    return ids;
+}
+
+TEST_CASE("Empty MappedRelationsMapIndex") {
+    osmium::index::RelationsMapStash stash;
+    const auto index = stash.build_member_to_parent_index();
+    const osmium::index::MappedRelationsMapIndex mapped{index};
+
+    REQUIRE(mapped.empty());
+    REQUIRE(mapped.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(get(mapped, 1).empty());
+}
+
+TEST_CASE("Small MappedRelationsMapIndex") {
+    osmium::index::RelationsMapStash stash;
+    stash.add(1, 2);
+    stash.add(2, 3);
+    stash.add(2, 4);
+    stash.add(7, 1);
+    const auto index = stash.build_member_to_parent_index();
+    const osmium::index::MappedRelationsMapIndex mapped{index};
+
+    REQUIRE(mapped.size() == 4);
+    REQUIRE(get(mapped, 0).empty());
+    REQUIRE(get(mapped, 1) == ids_type{2});
+    REQUIRE(get(mapped, 2) == (ids_type{3, 4}));
+    REQUIRE(get(mapped, 3).empty());
+    REQUIRE(get(mapped, 7) == ids_type{1});
+    REQUIRE(get(mapped, 8).empty());
+    REQUIRE(get(mapped, 1ULL << 40U).empty());
+}
+
+TEST_CASE("MappedRelationsMapIndex gives same results as RelationsMapIndex") {
+    osmium::index::RelationsMapStash stash;
+    for (osmium::unsigned_object_id_type id = 1; id < 10000; ++id) {
+        stash.add(id * 3, id / 7 + 1);
+        if (id % 5 == 0) {
+            stash.add(id * 3, id + 100000);
+        }
+    }
+    const auto index = stash.build_member_to_parent_index();
+    const osmium::index::MappedRelationsMapIndex mapped{index};
+    REQUIRE(mapped.size() == index.size());
+
+    for (osmium::unsigned_object_id_type id = 0; id < 30010; ++id) {
+        REQUIRE(get(mapped, id) == get(index, id));
+    }
+}
+
+TEST_CASE("Write MappedRelationsMapIndex to file and read it back") {
+    osmium::index::RelationsMapStash stash;
+    for (osmium::unsigned_object_id_type id = 1; id < 1000; ++id) {
+        stash.add(id, id * 2);
+        stash.add(id, id * 2 + 1);
+    }
+    const auto indexes = stash.build_indexes();
+
+    const int fd = osmium::detail::create_tmp_file();
+    {
+        const osmium::index::MappedRelationsMapIndex mapped{indexes.parent_to_member()};
+        mapped.write(fd);
+    }
+
+    const osmium::index::MappedRelationsMapIndex mapped{fd};
+    osmium::io::detail::reliable_close(fd);
+
+    REQUIRE(mapped.size() == 1998);
+    REQUIRE(get(mapped, 1).empty());
+    REQUIRE(get(mapped, 2) == ids_type{1});
+    REQUIRE(get(mapped, 1999) == ids_type{999});
+    REQUIRE(get(mapped, 2000).empty());
+}
+
+TEST_CASE("Reading invalid relations map file fails") {
+    const int fd = osmium::detail::create_tmp_file();
+    const std::vector<char> garbage(100, 'x');
+    osmium::io::detail::reliable_write(fd, garbage.data(), garbage.size());
+    REQUIRE_THROWS_AS(osmium::index::MappedRelationsMapIndex{fd}, osmium::relations_map_error);
+    osmium::io::detail::reliable_close(fd);
+}
@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/node_ways_map.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+static_assert(!std::is_default_constructible<osmium::index::NodeWaysMapIndex>::value, "NodeWaysMapIndex should not be default constructible");
+static_assert(!std::is_copy_constructible<osmium::index::NodeWaysMapIndex>::value, "NodeWaysMapIndex should not be copy constructible");
+
+using ids_type = std::vector<osmium::unsigned_object_id_type>;
+
+static void fill(osmium::index::NodeWaysMapStash& stash) {
+    // Way n contains the nodes n*10 to n*10+10, so neighbouring ways
+    // share one node. Every 100th node is also in way 1000000+n.
+    for (osmium::unsigned_object_id_type way = 1; way <= 10000; ++way) {
+        for (osmium::unsigned_object_id_type node = way * 10; node <= way * 10 + 10; ++node) {
+            stash.add(node, way);
+        }
+    }
+    for (osmium::unsigned_object_id_type node = 100; node <= 100000; node += 100) {
+        stash.add(node, 1000000 + node);
+    }
+}
+
+static void check_index(const osmium::index::NodeWaysMapIndex& index) {
+    REQUIRE(index.size() == 10000 * 11 + 1000);
+    REQUIRE(index.num_nodes() == 100001);
+    REQUIRE(index.used_memory() < index.size() * 8);
+
+    REQUIRE(index.get(5).empty());
+    REQUIRE(index.get(10) == ids_type{1});
+    REQUIRE(index.get(15) == ids_type{1});
+    REQUIRE(index.get(20) == (ids_type{1, 2}));
+    REQUIRE(index.get(4711) == ids_type{471});
+    REQUIRE(index.get(5000) == (ids_type{499, 500, 1005000}));
+    REQUIRE(index.get(100000) == (ids_type{9999, 10000, 1100000}));
+    REQUIRE(index.get(100010) == ids_type{10000});
+    REQUIRE(index.get(100011).empty());
+    REQUIRE(index.get(123456789).empty());
+
+    for (osmium::unsigned_object_id_type node = 11; node < 100000; node += 7) {
+        std::size_t count = 0;
+        index.for_each(node, [&](osmium::unsigned_object_id_type way) {
+            REQUIRE((way == node / 10 || way == node / 10 - 1 || way == 1000000 + node));
+            ++count;
+        });
+        const std::size_t expected = 1 + (node % 10 == 0 ? 1 : 0) + (node % 100 == 0 ? 1 : 0);
+        REQUIRE(count == expected);
+    }
+}
+
+TEST_CASE("Empty NodeWaysMapIndex") {
+    osmium::index::NodeWaysMapStash stash;
+    REQUIRE(stash.empty());
+
+    const auto index = stash.build_index();
+    REQUIRE(index.empty());
+    REQUIRE(index.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(index.get(1).empty());
+}
+
+TEST_CASE("NodeWaysMapIndex from ways") {
+    osmium::memory::Buffer buffer{1024};
+    {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+        osmium::builder::add_way(buffer, _id(20), _nodes({1, 2, 3, 1}));
+        osmium::builder::add_way(buffer, _id(10), _nodes({3, 4}));
+    }
+
+    osmium::index::NodeWaysMapStash stash;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        stash.add_way(way);
+    }
+    REQUIRE(stash.size() == 6);
+
+    const auto index = stash.build_index();
+    REQUIRE(index.size() == 5);
+    REQUIRE(index.num_nodes() == 4);
+    REQUIRE(index.get(1) == ids_type{20});
+    REQUIRE(index.get(3) == (ids_type{10, 20}));
+    REQUIRE(index.get(4) == ids_type{10});
+}
+
+TEST_CASE("NodeWaysMapIndex with many entries") {
+    osmium::index::NodeWaysMapStash stash;
+    fill(stash);
+    const auto index = stash.build_index();
+    check_index(index);
+}
+
+TEST_CASE("NodeWaysMapIndex built in parallel") {
+    osmium::thread::Pool pool{4};
+    osmium::index::NodeWaysMapStash stash;
+    fill(stash);
+    const auto index = stash.build_index(pool);
+    check_index(index);
+}
+
+TEST_CASE("Write NodeWaysMapIndex to file and read it back") {
+    osmium::index::NodeWaysMapStash stash;
+    fill(stash);
+    const auto index = stash.build_index();
+
+    const int fd = osmium::detail::create_tmp_file();
+    index.write(fd);
+
+    const osmium::index::NodeWaysMapIndex file_index{fd};
+    osmium::io::detail::reliable_close(fd);
+    check_index(file_index);
+}
+
+TEST_CASE("Reading invalid NodeWaysMapIndex file fails") {
+    const int fd = osmium::detail::create_tmp_file();
+    const std::vector<char> garbage(100, 'x');
+    osmium::io::detail::reliable_write(fd, garbage.data(), garbage.size());
+    REQUIRE_THROWS_AS(osmium::index::NodeWaysMapIndex{fd}, osmium::node_ways_map_error);
+    osmium::io::detail::reliable_close(fd);
+}
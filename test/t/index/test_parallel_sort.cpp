@@ -0,0 +1,101 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/parallel_sort.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map_parallel.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+using element_type = std::pair<uint64_t, uint32_t>;
+
+static std::vector<element_type> random_elements(std::size_t count, uint64_t max_id) {
+    std::mt19937_64 gen{42};
+    std::uniform_int_distribution<uint64_t> dist{0, max_id};
+    std::vector<element_type> elements;
+    elements.reserve(count);
+    for (std::size_t n = 0; n < count; ++n) {
+        elements.emplace_back(dist(gen), static_cast<uint32_t>(n));
+    }
+    return elements;
+}
+
+static void check_sort(std::vector<element_type> elements, osmium::thread::Pool& pool) {
+    std::vector<element_type> expected{elements};
+    std::sort(expected.begin(), expected.end());
+
+    osmium::index::detail::parallel_sort(elements.begin(), elements.end(), [](const element_type& element) {
+        return element.first;
+    }, pool);
+
+    REQUIRE(elements == expected);
+}
+
+TEST_CASE("Parallel sort of small range") {
+    osmium::thread::Pool pool{4};
+    check_sort(random_elements(0, 100), pool);
+    check_sort(random_elements(1, 100), pool);
+    check_sort(random_elements(1000, 100), pool);
+}
+
+TEST_CASE("Parallel sort of large range") {
+    osmium::thread::Pool pool{4};
+    check_sort(random_elements(200000, 10), pool);
+    check_sort(random_elements(200000, 500000), pool);
+    check_sort(random_elements(200000, 1ULL << 40U), pool);
+    check_sort(random_elements(200000, UINT64_MAX), pool);
+}
+
+TEST_CASE("Parallel sort with single thread pool") {
+    osmium::thread::Pool pool{1};
+    check_sort(random_elements(200000, 500000), pool);
+}
+
+TEST_CASE("Parallel sort of SparseMemArray after bulk set") {
+    using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+    osmium::thread::Pool pool{4};
+
+    std::vector<index_type::element_type> batch;
+    for (osmium::unsigned_object_id_type id = 200000; id > 0; --id) {
+        batch.emplace_back(id, osmium::Location{static_cast<int32_t>(id), 1});
+    }
+
+    index_type index;
+    index.set_bulk(batch.data(), 0);
+    REQUIRE(index.size() == 0);
+    index.set_bulk(batch.data(), 100000);
+    index.set_bulk(batch.data() + 100000, batch.size() - 100000);
+    REQUIRE(index.size() == 200000);
+
+    osmium::index::map::parallel_sort(index, pool);
+
+    REQUIRE(std::is_sorted(index.cbegin(), index.cend()));
+    REQUIRE(index.get(1) == osmium::Location(1, 1));
+    REQUIRE(index.get(123456) == osmium::Location(123456, 1));
+    REQUIRE(index.get_noexcept(200001) == osmium::Location{});
+}
+
+TEST_CASE("Parallel sort of FlexMem") {
+    using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+    osmium::thread::Pool pool{4};
+
+    index_type index;
+    for (osmium::unsigned_object_id_type id = 300000; id > 0; --id) {
+        index.set(id * 1000, osmium::Location{static_cast<int32_t>(id), 2});
+    }
+    REQUIRE_FALSE(index.is_dense());
+
+    osmium::index::map::parallel_sort(index, pool);
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 300000; ++id) {
+        REQUIRE(index.get(id * 1000) == osmium::Location(static_cast<int32_t>(id), 2));
+    }
+    REQUIRE(index.get_noexcept(1001) == osmium::Location{});
+}
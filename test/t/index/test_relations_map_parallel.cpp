@@ -0,0 +1,68 @@
+#include "catch.hpp"
+
+#include <osmium/index/relations_map.hpp>
+#include <osmium/index/relations_map_parallel.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <vector>
+
+static void fill_large(osmium::index::RelationsMapStash& stash) {
+    // Enough entries to make the parallel sort actually use the threads.
+    for (osmium::unsigned_object_id_type id = 200000; id > 0; --id) {
+        stash.add(id, (id * 7919) % 100003 + 1);
+        if (id % 3 == 0) {
+            stash.add(id, 1);
+            stash.add(id, 1);
+        }
+    }
+}
+
+static std::vector<osmium::unsigned_object_id_type> get(const osmium::index::RelationsMapIndex& index, osmium::unsigned_object_id_type id) {
+    std::vector<osmium::unsigned_object_id_type> ids;
+    index.for_each(id, [&ids](osmium::unsigned_object_id_type rid) {
+        ids.push_back(rid);
+    });
+    return ids;
+}
+
+TEST_CASE("RelationsMapStash build indexes in parallel") {
+    osmium::thread::Pool pool{4};
+
+    osmium::index::RelationsMapStash stash1;
+    fill_large(stash1);
+    const auto indexes1 = stash1.build_indexes();
+
+    osmium::index::RelationsMapStash stash2;
+    fill_large(stash2);
+    const auto indexes2 = osmium::index::parallel_build_indexes(stash2, pool);
+
+    REQUIRE(indexes1.size() == indexes2.size());
+    for (osmium::unsigned_object_id_type id = 0; id <= 200001; id += 13) {
+        REQUIRE(get(indexes1.member_to_parent(), id) == get(indexes2.member_to_parent(), id));
+        REQUIRE(get(indexes1.parent_to_member(), id) == get(indexes2.parent_to_member(), id));
+    }
+}
+
+TEST_CASE("RelationsMapStash build single index in parallel") {
+    osmium::thread::Pool pool{4};
+
+    osmium::index::RelationsMapStash stash1;
+    fill_large(stash1);
+    const auto index1 = stash1.build_parent_to_member_index();
+
+    osmium::index::RelationsMapStash stash2;
+    fill_large(stash2);
+    const auto index2 = osmium::index::parallel_build_parent_to_member_index(stash2, pool);
+
+    osmium::index::RelationsMapStash stash3;
+    fill_large(stash3);
+    const auto index3 = osmium::index::parallel_build_member_to_parent_index(stash3, pool);
+
+    REQUIRE(index1.size() == index2.size());
+    REQUIRE(index1.size() == index3.size());
+    REQUIRE(get(index2, 1).size() == 66667);
+    for (osmium::unsigned_object_id_type id = 0; id <= 100004; id += 7) {
+        REQUIRE(get(index1, id) == get(index2, id));
+    }
+    REQUIRE(get(index3, 3) == (std::vector<osmium::unsigned_object_id_type>{1, (3 * 7919) % 100003 + 1}));
+}
@@ -0,0 +1,104 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/bit_packing.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_compressed.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using index_type = osmium::index::map::SparseMemCompressed<osmium::unsigned_object_id_type, osmium::Location>;
+
+TEST_CASE("Bit packing helpers") {
+    REQUIRE(osmium::index::detail::bits_needed(0) == 0);
+    REQUIRE(osmium::index::detail::bits_needed(1) == 1);
+    REQUIRE(osmium::index::detail::bits_needed(255) == 8);
+    REQUIRE(osmium::index::detail::bits_needed(256) == 9);
+    REQUIRE(osmium::index::detail::bits_needed(UINT64_MAX) == 64);
+
+    std::vector<uint64_t> words;
+    osmium::index::detail::write_bits(words, 0, 5, 3);
+    osmium::index::detail::write_bits(words, 3, 0xabcdef0123ULL, 40);
+    osmium::index::detail::write_bits(words, 43, UINT64_MAX, 64);
+    osmium::index::detail::write_bits(words, 107, 1, 1);
+    REQUIRE(words.size() == 2);
+
+    REQUIRE(osmium::index::detail::read_bits(words.data(), 0, 3) == 5);
+    REQUIRE(osmium::index::detail::read_bits(words.data(), 3, 40) == 0xabcdef0123ULL);
+    REQUIRE(osmium::index::detail::read_bits(words.data(), 43, 64) == UINT64_MAX);
+    REQUIRE(osmium::index::detail::read_bits(words.data(), 107, 1) == 1);
+    REQUIRE(osmium::index::detail::read_bits(words.data(), 107, 0) == 0);
+}
+
+TEST_CASE("SparseMemCompressed with Ids in order") {
+    index_type index;
+
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.get_noexcept(1) == osmium::Location{});
+
+    for (osmium::unsigned_object_id_type id = 10; id < 10000; id += 3) {
+        index.set(id, osmium::Location{static_cast<int32_t>(id * 7), -static_cast<int32_t>(id)});
+    }
+
+    REQUIRE(index.size() == 3330);
+
+    for (osmium::unsigned_object_id_type id = 0; id < 10010; ++id) {
+        if (id >= 10 && id < 10000 && (id - 10) % 3 == 0) {
+            REQUIRE(index.get(id) == osmium::Location(static_cast<int32_t>(id * 7), -static_cast<int32_t>(id)));
+        } else {
+            REQUIRE(index.get_noexcept(id) == osmium::Location{});
+            REQUIRE_THROWS_AS(index.get(id), osmium::not_found);
+        }
+    }
+
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> uncompressed;
+    for (osmium::unsigned_object_id_type id = 10; id < 10000; id += 3) {
+        uncompressed.set(id, osmium::Location{static_cast<int32_t>(id * 7), -static_cast<int32_t>(id)});
+    }
+    REQUIRE(index.used_memory() * 2 < uncompressed.used_memory());
+}
+
+TEST_CASE("SparseMemCompressed with extreme values") {
+    index_type index;
+
+    const osmium::Location loc1{-180.0, -90.0};
+    const osmium::Location loc2{180.0, 90.0};
+
+    index.set(1, loc1);
+    index.set(2, loc2);
+    index.set(3, osmium::Location{});
+    index.set(1ULL << 40U, loc1);
+
+    REQUIRE(index.get(1) == loc1);
+    REQUIRE(index.get(2) == loc2);
+    REQUIRE(index.get_noexcept(3) == osmium::Location{});
+    REQUIRE(index.get(1ULL << 40U) == loc1);
+}
+
+TEST_CASE("SparseMemCompressed with Ids out of order") {
+    index_type index;
+
+    for (osmium::unsigned_object_id_type id = 1000; id > 0; --id) {
+        index.set(id, osmium::Location{static_cast<int32_t>(id), 1});
+    }
+    index.set(500, osmium::Location{2, 3});
+
+    REQUIRE(index.size() == 1001);
+
+    index.sort();
+
+    REQUIRE(index.size() == 1000);
+    REQUIRE(index.get_noexcept(0) == osmium::Location{});
+    REQUIRE(index.get(1) == osmium::Location(1, 1));
+    REQUIRE(index.get(499) == osmium::Location(499, 1));
+    REQUIRE(index.get(500) == osmium::Location(2, 3));
+    REQUIRE(index.get(1000) == osmium::Location(1000, 1));
+    REQUIRE(index.get_noexcept(1001) == osmium::Location{});
+
+    index.clear();
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.get_noexcept(1) == osmium::Location{});
+}
+
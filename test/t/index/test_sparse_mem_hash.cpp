@@ -0,0 +1,97 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/map/sparse_mem_hash.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/util/file.hpp>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using index_type = osmium::index::map::SparseMemHash<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id % 1000000), static_cast<int32_t>(id % 1001)};
+}
+
+TEST_CASE("SparseMemHash with sequential Ids") {
+    index_type index;
+    for (osmium::unsigned_object_id_type id = 1; id <= 100000; ++id) {
+        index.set(id, location_for(id));
+    }
+    REQUIRE(index.size() == 100000);
+    REQUIRE(index.used_memory() <= 2 * 100000 * (1 + sizeof(osmium::unsigned_object_id_type) + sizeof(osmium::Location)) + 1000);
+
+    for (osmium::unsigned_object_id_type id = 1; id <= 100000; ++id) {
+        REQUIRE(index.get(id) == location_for(id));
+    }
+    REQUIRE(index.get_noexcept(0) == osmium::Location{});
+    REQUIRE(index.get_noexcept(100001) == osmium::Location{});
+    REQUIRE_THROWS_AS(index.get(100001), osmium::not_found);
+}
+
+TEST_CASE("SparseMemHash with interleaved set and get") {
+    std::mt19937_64 gen{17}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::uniform_int_distribution<osmium::unsigned_object_id_type> dist{0, 1ULL << 40U};
+
+    index_type index;
+    std::map<osmium::unsigned_object_id_type, osmium::Location> reference;
+
+    for (int i = 0; i < 50000; ++i) {
+        const auto id = dist(gen);
+        const osmium::Location location{i, i % 100};
+        index.set(id, location);
+        reference[id] = location;
+
+        const auto query = dist(gen) % 2 == 0 ? id : dist(gen);
+        const auto it = reference.find(query);
+        REQUIRE(index.get_noexcept(query) == (it == reference.end() ? osmium::Location{} : it->second));
+    }
+
+    REQUIRE(index.size() == reference.size());
+    for (const auto& element : reference) {
+        REQUIRE(index.get(element.first) == element.second);
+    }
+
+    // overwrite existing values
+    for (const auto& element : reference) {
+        index.set(element.first, osmium::Location{1, 2});
+    }
+    REQUIRE(index.size() == reference.size());
+    REQUIRE(index.get(reference.begin()->first) == (osmium::Location{1, 2}));
+}
+
+TEST_CASE("SparseMemHash reserve, bulk lookup, and dump") {
+    index_type index;
+    index.reserve(1000);
+    const auto memory = index.used_memory();
+
+    for (osmium::unsigned_object_id_type id = 1000; id > 0; --id) {
+        index.set(id * 1000, location_for(id));
+    }
+    REQUIRE(index.used_memory() == memory);
+
+    const std::vector<osmium::unsigned_object_id_type> ids{5000, 17, 1000000, 999};
+    std::vector<osmium::Location> locations(ids.size());
+    index.get_noexcept_bulk(ids.data(), ids.size(), locations.data());
+    REQUIRE(locations[0] == location_for(5));
+    REQUIRE(locations[1] == osmium::Location{});
+    REQUIRE(locations[2] == location_for(1000));
+    REQUIRE(locations[3] == osmium::Location{});
+
+    const int fd = osmium::detail::create_tmp_file();
+    index.dump_as_list(fd);
+    REQUIRE(osmium::file_size(fd) == 1000 * sizeof(std::pair<osmium::unsigned_object_id_type, osmium::Location>));
+    osmium::io::detail::reliable_close(fd);
+
+    index.clear();
+    REQUIRE(index.size() == 0); // NOLINT(readability-container-size-empty)
+    REQUIRE(index.get_noexcept(5000) == osmium::Location{});
+    index.set(5, location_for(5));
+    REQUIRE(index.get(5) == location_for(5));
+}
@@ -0,0 +1,118 @@
+#include "catch.hpp"
+
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_interpolated.hpp>
+#include <osmium/index/map_parallel.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using index_type = osmium::index::map::SparseMemInterpolated<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id % 1000000), static_cast<int32_t>(id / 1000)};
+}
+
+static std::vector<osmium::unsigned_object_id_type> make_ids() {
+    // Several ranges of Ids with different densities and a few outliers.
+    std::vector<osmium::unsigned_object_id_type> ids;
+    std::mt19937 gen{42}; // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    std::uniform_int_distribution<osmium::unsigned_object_id_type> dist{1, 10};
+
+    for (osmium::unsigned_object_id_type id = 1; id < 100000; ++id) {
+        ids.push_back(id);
+    }
+    for (osmium::unsigned_object_id_type id = 5000000; id < 6000000; id += dist(gen)) {
+        ids.push_back(id);
+    }
+    for (osmium::unsigned_object_id_type id = 7000000; id < 7100000; id += dist(gen) * dist(gen) * 100) {
+        ids.push_back(id);
+    }
+    ids.push_back(1ULL << 33U);
+    ids.push_back((1ULL << 33U) + 1);
+    ids.push_back(1ULL << 40U);
+
+    std::shuffle(ids.begin(), ids.end(), gen);
+    return ids;
+}
+
+static void check(const index_type& index, const std::vector<osmium::unsigned_object_id_type>& ids) {
+    osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location> reference;
+    for (const auto id : ids) {
+        reference.set(id, location_for(id));
+    }
+    reference.sort();
+
+    REQUIRE(index.size() == ids.size());
+    REQUIRE(index.num_segments() > 0);
+    REQUIRE(index.num_segments() < ids.size() / 100);
+
+    for (const auto id : ids) {
+        REQUIRE(index.get(id) == location_for(id));
+    }
+    for (osmium::unsigned_object_id_type id = 0; id < 7200000; id += 17) {
+        REQUIRE(index.get_noexcept(id) == reference.get_noexcept(id));
+    }
+    REQUIRE(index.get_noexcept((1ULL << 33U) + 2) == osmium::Location{});
+    REQUIRE(index.get_noexcept((1ULL << 40U) + 1) == osmium::Location{});
+    REQUIRE_THROWS_AS(index.get(99999999), osmium::not_found);
+}
+
+TEST_CASE("SparseMemInterpolated with many Ids") {
+    const auto ids = make_ids();
+
+    index_type index;
+    for (const auto id : ids) {
+        index.set(id, location_for(id));
+    }
+    index.sort();
+
+    check(index, ids);
+}
+
+TEST_CASE("SparseMemInterpolated sorted in parallel") {
+    const auto ids = make_ids();
+    osmium::thread::Pool pool{4};
+
+    index_type index;
+    for (const auto id : ids) {
+        index.set(id, location_for(id));
+    }
+    osmium::index::map::parallel_sort(index, pool);
+
+    check(index, ids);
+}
+
+TEST_CASE("SparseMemInterpolated with duplicate Ids") {
+    index_type index;
+    for (osmium::unsigned_object_id_type id = 0; id < 1000; ++id) {
+        index.set(id * 3, location_for(id));
+        if (id % 10 == 0) {
+            index.set(id * 3, location_for(id));
+        }
+    }
+    index.sort();
+
+    for (osmium::unsigned_object_id_type id = 0; id < 1000; ++id) {
+        REQUIRE(index.get(id * 3) == location_for(id));
+        REQUIRE(index.get_noexcept(id * 3 + 1) == osmium::Location{});
+    }
+}
+
+TEST_CASE("SparseMemInterpolated falls back to binary search after set") {
+    index_type index;
+    for (osmium::unsigned_object_id_type id = 10; id < 1000; id += 10) {
+        index.set(id, location_for(id));
+    }
+    index.sort();
+    REQUIRE(index.num_segments() == 1);
+
+    index.set(5000, location_for(5000));
+    REQUIRE(index.num_segments() == 0);
+    REQUIRE(index.get(500) == location_for(500));
+    REQUIRE(index.get(5000) == location_for(5000));
+}
@@ -0,0 +1,117 @@
+#include "catch.hpp"
+
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/map/dense_mem_array.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/index/map/updatable_location_cache.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using cache_type = osmium::index::map::UpdatableLocationCache<osmium::unsigned_object_id_type, osmium::Location>;
+
+static osmium::Location location_for(const osmium::unsigned_object_id_type id) {
+    return osmium::Location{static_cast<int32_t>(id * 3), static_cast<int32_t>(id)};
+}
+
+template <typename TIndex>
+static int create_cache(const osmium::index::map::location_cache_type type) {
+    const int fd = osmium::detail::create_tmp_file();
+
+    TIndex index;
+    for (osmium::unsigned_object_id_type id = 10; id <= 100; id += 10) {
+        index.set(id, location_for(id));
+    }
+    osmium::index::map::write_location_cache(fd, index, type, osmium::Timestamp{"2023-10-01T00:00:00Z"});
+
+    return fd;
+}
+
+static void update(cache_type& cache) {
+    cache.set(20, location_for(21));  // change
+    cache.set(25, location_for(25));  // new in the middle
+    cache.set(5, location_for(5));    // new at the beginning
+    cache.set(200, location_for(200)); // new at the end
+    cache.remove(30);
+    cache.remove(100);
+    cache.remove(77); // does not exist
+}
+
+static void check_updated(const cache_type& cache) {
+    REQUIRE(cache.get(5) == location_for(5));
+    REQUIRE(cache.get(10) == location_for(10));
+    REQUIRE(cache.get(20) == location_for(21));
+    REQUIRE(cache.get(25) == location_for(25));
+    REQUIRE(cache.get(40) == location_for(40));
+    REQUIRE(cache.get(200) == location_for(200));
+    REQUIRE_THROWS_AS(cache.get(30), osmium::not_found);
+    REQUIRE_THROWS_AS(cache.get(77), osmium::not_found);
+    REQUIRE_THROWS_AS(cache.get(100), osmium::not_found);
+    REQUIRE(cache.get_noexcept(100) == osmium::Location{});
+
+    const std::vector<osmium::unsigned_object_id_type> ids{5, 10, 20, 30, 90, 100, 200};
+    std::vector<osmium::Location> locations(ids.size());
+    cache.get_noexcept_bulk(ids.data(), ids.size(), locations.data());
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        REQUIRE(locations[i] == cache.get_noexcept(ids[i]));
+    }
+}
+
+static void test_update_and_compact(const int fd) {
+    cache_type cache{fd};
+    REQUIRE(cache.overlay_size() == 0);
+    REQUIRE(cache.get(20) == location_for(20));
+
+    update(cache);
+    REQUIRE(cache.overlay_size() == 7);
+    check_updated(cache);
+
+    const int new_fd = osmium::detail::create_tmp_file();
+    const osmium::Timestamp timestamp{"2023-10-02T00:00:00Z"};
+    const auto header = cache.compact(new_fd, timestamp);
+
+    REQUIRE(header.max_id == 200);
+    REQUIRE(cache.overlay_size() == 0);
+    REQUIRE(cache.base().timestamp() == timestamp);
+    REQUIRE(cache.base().verify());
+    check_updated(cache);
+
+    // reopen compacted file
+    const cache_type reopened{new_fd};
+    check_updated(reopened);
+}
+
+TEST_CASE("Updatable location cache: sparse") {
+    const int fd = create_cache<osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>>(osmium::index::map::location_cache_type::sparse);
+    test_update_and_compact(fd);
+
+    cache_type cache{fd};
+    update(cache);
+    const auto header = cache.compact(osmium::detail::create_tmp_file(), osmium::Timestamp{});
+    REQUIRE(header.min_id == 5);
+    REQUIRE(header.count == 11);
+}
+
+TEST_CASE("Updatable location cache: dense") {
+    const int fd = create_cache<osmium::index::map::DenseMemArray<osmium::unsigned_object_id_type, osmium::Location>>(osmium::index::map::location_cache_type::dense);
+    test_update_and_compact(fd);
+
+    cache_type cache{fd};
+    update(cache);
+    const auto header = cache.compact(osmium::detail::create_tmp_file(), osmium::Timestamp{});
+    REQUIRE(header.min_id == 0);
+    REQUIRE(header.count == 201);
+}
+
+TEST_CASE("Updatable location cache: compact without changes") {
+    const int fd = create_cache<osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>>(osmium::index::map::location_cache_type::sparse);
+    cache_type cache{fd};
+    const auto checksum = cache.base().header().checksum;
+
+    cache.compact(osmium::detail::create_tmp_file(), osmium::Timestamp{"2023-10-01T00:00:00Z"});
+    REQUIRE(cache.base().header().checksum == checksum);
+    REQUIRE(cache.base().size() == 10);
+}
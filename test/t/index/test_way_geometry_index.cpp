@@ -0,0 +1,136 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/index/detail/tmpfile.hpp>
+#include <osmium/index/way_geometry_index.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <vector>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+static void add_ways(osmium::memory::Buffer& buffer) {
+    osmium::builder::add_way(buffer, _id(10), _nodes({
+        osmium::NodeRef{1, osmium::Location{1.0, 2.0}},
+        osmium::NodeRef{2, osmium::Location{1.5, 2.5}},
+        osmium::NodeRef{3, osmium::Location{-179.9999999, 89.9999999}}
+    }));
+    osmium::builder::add_way(buffer, _id(5), _nodes({
+        osmium::NodeRef{4, osmium::Location{3.0, 4.0}},
+        osmium::NodeRef{5, osmium::Location{}}
+    }));
+    osmium::builder::add_way(buffer, _id(7), _nodes({4, 5}));
+}
+
+static void check_index(osmium::index::WayGeometryIndex& index) {
+    index.sort();
+
+    REQUIRE(index.size() == 3);
+    REQUIRE(index.contains(5));
+    REQUIRE(index.contains(7));
+    REQUIRE(index.contains(10));
+    REQUIRE_FALSE(index.contains(6));
+
+    const auto locations = index.get(10);
+    REQUIRE(locations.size() == 3);
+    REQUIRE(locations[0] == osmium::Location(1.0, 2.0));
+    REQUIRE(locations[1] == osmium::Location(1.5, 2.5));
+    REQUIRE(locations[2] == osmium::Location(-179.9999999, 89.9999999));
+
+    const auto locations5 = index.get(5);
+    REQUIRE(locations5.size() == 2);
+    REQUIRE(locations5[0] == osmium::Location(3.0, 4.0));
+    REQUIRE_FALSE(locations5[1].valid());
+
+    int count = 0;
+    REQUIRE(index.for_each_location(7, [&count](const osmium::Location& location) {
+        REQUIRE_FALSE(location.valid());
+        ++count;
+    }));
+    REQUIRE(count == 2);
+
+    REQUIRE_FALSE(index.for_each_location(6, [](const osmium::Location& /*location*/) {}));
+    REQUIRE_THROWS_AS(index.get(6), osmium::not_found);
+}
+
+TEST_CASE("Empty way geometry index") {
+    osmium::index::WayGeometryIndex index;
+    REQUIRE(index.empty());
+    REQUIRE(index.size() == 0);
+    REQUIRE_FALSE(index.contains(1));
+    REQUIRE_THROWS_AS(index.get(1), osmium::not_found);
+}
+
+TEST_CASE("Way geometry index in memory") {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    add_ways(buffer);
+
+    osmium::index::WayGeometryIndex index;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        index.add_way(way);
+    }
+    REQUIRE_FALSE(index.empty());
+
+    check_index(index);
+
+    index.clear();
+    REQUIRE(index.empty());
+    REQUIRE_FALSE(index.contains(10));
+}
+
+TEST_CASE("Way geometry index in file") {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    add_ways(buffer);
+
+    const int fd = osmium::detail::create_tmp_file();
+    osmium::index::WayGeometryIndex index{fd};
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        index.add_way(way);
+    }
+
+    check_index(index);
+}
+
+TEST_CASE("Set locations on way from way geometry index") {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    add_ways(buffer);
+
+    osmium::index::WayGeometryIndex index;
+    index.add_way(buffer.get<osmium::Way>(0));
+
+    osmium::memory::Buffer buffer2{10240, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_way(buffer2, _id(10), _nodes({1, 2, 3}));
+    osmium::builder::add_way(buffer2, _id(10), _nodes({1, 2}));
+    auto it = buffer2.select<osmium::Way>().begin();
+
+    auto& way = *it;
+    REQUIRE(index.set_locations(way.positive_id(), way.nodes()));
+    REQUIRE(way.nodes()[0].location() == osmium::Location(1.0, 2.0));
+    REQUIRE(way.nodes()[2].location() == osmium::Location(-179.9999999, 89.9999999));
+
+    auto& way2 = *++it;
+    REQUIRE_FALSE(index.set_locations(way2.positive_id(), way2.nodes()));
+    REQUIRE_FALSE(way2.nodes()[0].location().valid());
+}
+
+TEST_CASE("Way geometry index with many ways") {
+    osmium::index::WayGeometryIndex index;
+
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    for (osmium::object_id_type id = 1; id <= 20000; ++id) {
+        std::vector<osmium::NodeRef> nodes;
+        for (int n = 0; n < 10; ++n) {
+            nodes.emplace_back(n, osmium::Location{static_cast<int32_t>(id * 1000 + n), static_cast<int32_t>(-id * 1000 - n * 7)});
+        }
+        buffer.clear();
+        osmium::builder::add_way(buffer, _id(20001 - id), _nodes(nodes));
+        index.add_way(buffer.get<osmium::Way>(0));
+    }
+    index.sort();
+
+    REQUIRE(index.size() == 20000);
+    const auto locations = index.get(20001 - 1234);
+    REQUIRE(locations.size() == 10);
+    REQUIRE(locations[9] == osmium::Location(1234 * 1000 + 9, -1234 * 1000 - 63));
+}
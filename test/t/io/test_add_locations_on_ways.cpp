@@ -0,0 +1,94 @@
+#include "catch.hpp"
+
+#include <osmium/handler/check_locations_on_ways.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/sparse_mem_array.hpp>
+#include <osmium/io/add_locations_on_ways.hpp>
+#include <osmium/io/opl_input.hpp>
+#include <osmium/io/opl_output.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using index_type = osmium::index::map::SparseMemArray<osmium::unsigned_object_id_type, osmium::Location>;
+
+static const char* input_data =
+    "n1 v1 x1 y1\n"
+    "n2 v1 x2 y1 Tamenity=pub\n"
+    "n3 v1 x3 y1\n"
+    "n4 v1 x4 y1\n"
+    "w10 v1 Nn1,n2,n3\n"
+    "w11 v1 Nn3,n1\n"
+    "r20 v1 Mn4@stop,w10@\n";
+
+static std::string convert(const osmium::io::untagged_nodes nodes) {
+    const std::string filename{"test-add-locations-on-ways-out.opl"};
+
+    osmium::thread::Pool pool{2};
+    const osmium::io::File input{input_data, std::strlen(input_data), "opl"};
+    osmium::io::Writer writer{osmium::io::File{filename, "opl,locations_on_ways=true"}, osmium::io::overwrite::allow};
+
+    index_type index;
+    osmium::handler::NodeLocationsForWays<index_type> location_handler{index};
+    osmium::io::add_locations_on_ways(input, writer, location_handler, pool, nodes);
+
+    writer.close();
+
+    return filename;
+}
+
+static std::vector<osmium::object_id_type> node_ids(const osmium::memory::Buffer& buffer) {
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        ids.push_back(node.id());
+    }
+    return ids;
+}
+
+TEST_CASE("Add locations on ways and drop untagged nodes") {
+    const auto filename = convert(osmium::io::untagged_nodes::remove);
+
+    osmium::io::Reader reader{filename};
+    const auto buffer = reader.read();
+    reader.close();
+
+    REQUIRE(node_ids(buffer) == std::vector<osmium::object_id_type>{2});
+    REQUIRE(std::distance(buffer.select<osmium::Way>().begin(), buffer.select<osmium::Way>().end()) == 2);
+    REQUIRE(std::distance(buffer.select<osmium::Relation>().begin(), buffer.select<osmium::Relation>().end()) == 1);
+
+    const auto& way = *buffer.select<osmium::Way>().begin();
+    REQUIRE(way.id() == 10);
+    REQUIRE(way.nodes()[2].location() == osmium::Location(3.0, 1.0));
+
+    osmium::handler::CheckLocationsOnWays check{1};
+    osmium::apply(buffer, check);
+    REQUIRE(check.checked() == 2);
+}
+
+TEST_CASE("Add locations on ways and keep untagged relation member nodes") {
+    const auto filename = convert(osmium::io::untagged_nodes::keep_members);
+
+    osmium::io::Reader reader{filename};
+    const auto buffer = reader.read();
+    reader.close();
+
+    REQUIRE(node_ids(buffer) == (std::vector<osmium::object_id_type>{2, 4}));
+    REQUIRE(buffer.select<osmium::Way>().begin()->nodes()[2].location() == osmium::Location(3.0, 1.0));
+}
+
+TEST_CASE("Add locations on ways and keep untagged nodes") {
+    const auto filename = convert(osmium::io::untagged_nodes::keep);
+
+    osmium::io::Reader reader{filename};
+    const auto buffer = reader.read();
+    reader.close();
+
+    REQUIRE(node_ids(buffer) == (std::vector<osmium::object_id_type>{1, 2, 3, 4}));
+}
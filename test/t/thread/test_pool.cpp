@@ -2,7 +2,10 @@
 
 #include <osmium/thread/pool.hpp>
 
+#include <atomic>
+#include <cstddef>
 #include <stdexcept>
+#include <vector>
 
 struct test_job_with_result {
     int operator()() const {
@@ -104,3 +107,26 @@ TEST_CASE("can throw from job in user provided thread pool") {
     REQUIRE_THROWS_AS(future.get(), std::runtime_error);
 }
 
+
+TEST_CASE("can run tasks in parallel and wait for them") {
+    osmium::thread::Pool pool{4};
+    std::vector<int> results(100, 0);
+    osmium::thread::run_in_parallel(pool, results.size(), [&results](std::size_t n) {
+        results[n] = static_cast<int>(n) * 2;
+    });
+    for (std::size_t n = 0; n < results.size(); ++n) {
+        REQUIRE(results[n] == static_cast<int>(n) * 2);
+    }
+}
+
+TEST_CASE("exceptions in tasks run in parallel are propagated") {
+    osmium::thread::Pool pool{4};
+    std::atomic<int> count{0};
+    REQUIRE_THROWS_AS(osmium::thread::run_in_parallel(pool, 10, [&count](std::size_t n) {
+        ++count;
+        if (n == 3) {
+            throw std::runtime_error{"exception in pool thread"};
+        }
+    }), std::runtime_error);
+    REQUIRE(count == 10);
+}